@@ -0,0 +1,44 @@
+#include "Debouncer.h"
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+Debouncer::Debouncer(unsigned int initial)
+{
+    reset(initial);
+}
+
+void Debouncer::reset(unsigned int initial)
+{
+    debounced = initial;
+    count0 = 0;
+    count1 = 0;
+    count2 = 0;
+}
+
+//**************************************************************************
+//UPDATE
+//**************************************************************************
+// Feed one sample of all inputs - returns the changed bits mask
+unsigned int Debouncer::update(unsigned int sample)
+{
+    unsigned int delta = sample ^ debounced;
+    unsigned int changed;
+
+    //Count up where the input differs, clear where it agrees
+    count2 = (count2 ^ (count1 & count0)) & delta;
+    count1 = (count1 ^ count0) & delta;
+    count0 = ~count0 & delta;
+
+    //Counter reached DEBOUNCE_SAMPLES (7) - take the new level
+    changed = count2 & count1 & count0;
+    debounced ^= changed;
+
+    //Flipped inputs agree again - clear their counters
+    count0 &= ~changed;
+    count1 &= ~changed;
+    count2 &= ~changed;
+
+    return changed;
+}
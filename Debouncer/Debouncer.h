@@ -0,0 +1,33 @@
+
+#ifndef Debouncer_H
+#define Debouncer_H
+
+#define DEBOUNCE_SAMPLES    7           // consecutive samples a new level must hold
+
+//**************************************************************************
+//DEBOUNCER
+//**************************************************************************
+// Debounces up to 32 inputs at once with 3 bit vertical counters: bit n of
+// count0..count2 is the counter of input n. A counter runs while its input
+// differs from the debounced state and is cleared as soon as it agrees
+// again, so an input flips after DEBOUNCE_SAMPLES differing samples in a
+// row. One update is a handful of bitwise operations whatever the number
+// of inputs.
+class Debouncer
+{
+public:
+    Debouncer(unsigned int initial = 0xFFFFFFFF);
+
+    void reset(unsigned int initial);
+    unsigned int update(unsigned int sample);       // returns the inputs that changed
+
+    unsigned int state() { return debounced; }
+
+private:
+    unsigned int debounced;
+    unsigned int count0;
+    unsigned int count1;
+    unsigned int count2;
+};
+
+#endif
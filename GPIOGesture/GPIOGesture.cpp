@@ -0,0 +1,98 @@
+#include "GPIOGesture.h"
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+GPIOGesture::GPIOGesture()
+{
+    handler = NULL;
+    longPress_ms = GPIO_LONG_PRESS_MS;
+    doublePress_ms = GPIO_DOUBLE_PRESS_MS;
+
+    for (int i = 0; i < GPIO_COUNT; i++)
+    {
+        pressed[i] = false;
+        held[i] = false;
+        tapped[i] = false;
+        pressTime[i] = 0;
+        releaseTime[i] = 0;
+    }
+}
+
+//**************************************************************************
+//UPDATE
+//**************************************************************************
+// Feed one debounced level change - inputs are pulled up, 0 = pressed
+void GPIOGesture::update(const GPIOEvent& event)
+{
+    int i = event.pin - 1;
+
+    if ((i < 0) || (i >= GPIO_COUNT)) return;
+
+    //Press
+    if ((event.level == 0) && !pressed[i])
+    {
+        pressed[i] = true;
+        held[i] = false;
+        pressTime[i] = event.time_us;
+        report(event.pin, GPIO_GESTURE_PRESS, event.time_us);
+
+        //Second tap - a third one starts over
+        if (tapped[i] && ((event.time_us - releaseTime[i]) <= doublePress_ms * 1000))
+        {
+            tapped[i] = false;
+            report(event.pin, GPIO_GESTURE_DOUBLE, event.time_us);
+        }
+        else
+        {
+            tapped[i] = true;
+        }
+    }
+
+    //Release
+    else if ((event.level != 0) && pressed[i])
+    {
+        pressed[i] = false;
+        releaseTime[i] = event.time_us;
+        if (held[i]) tapped[i] = false;
+        report(event.pin, GPIO_GESTURE_RELEASE, event.time_us);
+    }
+}
+
+//**************************************************************************
+//POLL
+//**************************************************************************
+// Report due long presses, stamped press time + longPress_ms - returns the ms until the next one is due, at most idle_ms
+unsigned int GPIOGesture::poll(unsigned int idle_ms)
+{
+    unsigned int now = us_ticker_read();
+    unsigned int wait_ms = idle_ms;
+    unsigned int due;
+    int remaining;
+
+    for (int i = 0; i < GPIO_COUNT; i++)
+    {
+        if (!pressed[i] || held[i]) continue;
+
+        due = pressTime[i] + longPress_ms * 1000;
+        remaining = due - now;
+
+        if (remaining <= 0)
+        {
+            held[i] = true;
+            report(i + 1, GPIO_GESTURE_LONG, due);
+        }
+        else if ((unsigned int)(remaining / 1000 + 1) < wait_ms)
+        {
+            wait_ms = remaining / 1000 + 1;
+        }
+    }
+
+    return wait_ms;
+}
+
+void GPIOGesture::report(int pin, int gesture, unsigned int time_us)
+{
+    if (handler != NULL) handler(pin, gesture, time_us);
+}
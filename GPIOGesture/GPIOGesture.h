@@ -0,0 +1,47 @@
+
+#ifndef GPIOGesture_H
+#define GPIOGesture_H
+
+#define GPIO_GESTURE_PRESS      0           // same value as the old LOW feedback
+#define GPIO_GESTURE_RELEASE    1
+#define GPIO_GESTURE_LONG       2
+#define GPIO_GESTURE_DOUBLE     3
+
+#define GPIO_LONG_PRESS_MS      800         // held this long - long press
+#define GPIO_DOUBLE_PRESS_MS    350         // pressed again within this after a release - double press
+
+#include "mbed.h"
+#include "us_ticker_api.h"
+#include "GPIOInput.h"
+
+//**************************************************************************
+//GPIO GESTURE
+//**************************************************************************
+// Classifies debounced GPIO levels into press, release, long & double press per input.
+// poll() fires due long presses and tells the caller how long it may wait.
+class GPIOGesture
+{
+public:
+    GPIOGesture();
+
+    void attach(void (*function)(int pin, int gesture, unsigned int time_us)) { handler = function; }
+
+    void update(const GPIOEvent& event);
+    unsigned int poll(unsigned int idle_ms);
+
+    unsigned int longPress_ms;
+    unsigned int doublePress_ms;
+
+private:
+    void report(int pin, int gesture, unsigned int time_us);
+
+    void (*handler)(int pin, int gesture, unsigned int time_us);
+
+    bool pressed[GPIO_COUNT];
+    bool held[GPIO_COUNT];                  // long press already reported
+    bool tapped[GPIO_COUNT];                // last press was a short tap - a double press may follow
+    unsigned int pressTime[GPIO_COUNT];
+    unsigned int releaseTime[GPIO_COUNT];
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "GPIOInput.h"
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+GPIOInput::GPIOInput(const PinName* pins, unsigned int edgeMask) : pins(pins), edgeMask(edgeMask)
+{
+    edges = 0;
+    lost = 0;
+    portCount = 0;
+    stamped = 0;
+
+    for (int i = 0; i < GPIO_COUNT; i++)
+    {
+        input[i] = NULL;
+        edgeIn[i] = NULL;
+        pinPort[i] = 0;
+        pinBit[i] = 0;
+        since[i] = 0;
+    }
+}
+
+//**************************************************************************
+//START
+//**************************************************************************
+// Configure the pins & attach the interrupts - pull-up inputs, idle high
+void GPIOInput::start()
+{
+    LPC_GPIO_TypeDef* gpio;
+    int p;
+
+    for (int i = 0; i < GPIO_COUNT; i++)
+    {
+        input[i] = new DigitalIn(pins[i]);
+        input[i]->mode(PullUp);
+
+        //Port register & bit of the pin - mbed pin names are the port address + bit
+        gpio = (LPC_GPIO_TypeDef*)((int)pins[i] & ~0x1F);
+        for (p = 0; (p < portCount) && (port[p] != gpio); p++);
+        if (p == portCount) port[portCount++] = gpio;
+
+        pinPort[i] = p;
+        pinBit[i] = (int)pins[i] & 0x1F;
+
+        if (edgeMask & (1 << i))
+        {
+            edgeIn[i] = new InterruptIn(pins[i]);
+            edgeIn[i]->mode(PullUp);
+            edgeIn[i]->fall(this, &GPIOInput::edge);
+            edgeIn[i]->rise(this, &GPIOInput::edge);
+        }
+    }
+
+    debouncer.reset(sample());
+    ticker.attach_us(this, &GPIOInput::tick, GPIO_TICK_US);
+}
+
+//**************************************************************************
+//GET
+//**************************************************************************
+// Wait for the next debounced change - false on timeout
+bool GPIOInput::get(GPIOEvent* event, unsigned int timeout_ms)
+{
+    osEvent evt = mail.get(timeout_ms);
+
+    if (evt.status != osEventMail) return false;
+
+    *event = *(GPIOEvent*)evt.value.p;
+    mail.free((GPIOEvent*)evt.value.p);
+
+    return true;
+}
+
+//**************************************************************************
+//INTERRUPTS
+//**************************************************************************
+// Interrupt Routine - edge on any pin with an InterruptIn
+void GPIOInput::edge()
+{
+    edges++;
+    stamp(sample() ^ debouncer.state(), us_ticker_read());
+}
+
+// Interrupt Routine - debounce tick
+void GPIOInput::tick()
+{
+    GPIOEvent* event;
+    unsigned int level = sample();
+    unsigned int changed = debouncer.update(level);
+    unsigned int now = us_ticker_read();
+
+    //Pins without edge interrupts are stamped here
+    stamp((level ^ debouncer.state()) | changed, now);
+
+    //Post every changed pin
+    for (int i = 0; changed != 0; i++, changed >>= 1)
+    {
+        if ((changed & 1) == 0) continue;
+
+        event = mail.alloc();
+        if (event == NULL)
+        {
+            lost++;
+            continue;
+        }
+
+        event->pin = i + 1;
+        event->level = (debouncer.state() >> i) & 1;
+        event->time_us = since[i];
+        mail.put(event);
+    }
+
+    //Pins back at their debounced level drop their timestamp
+    stamped &= level ^ debouncer.state();
+}
+
+//**************************************************************************
+//SAMPLE
+//**************************************************************************
+// One read per port register - bit n = level of pin n + 1
+unsigned int GPIOInput::sample()
+{
+    unsigned int value[GPIO_PORTS];
+    unsigned int level = 0;
+
+    for (int p = 0; p < portCount; p++) value[p] = port[p]->FIOPIN;
+
+    for (int i = 0; i < GPIO_COUNT; i++)
+    {
+        level |= ((value[pinPort[i]] >> pinBit[i]) & 1) << i;
+    }
+
+    return level;
+}
+
+// Timestamp pins that start to differ from their debounced level
+void GPIOInput::stamp(unsigned int pending, unsigned int now)
+{
+    unsigned int fresh = pending & ~stamped;
+
+    for (int i = 0; fresh != 0; i++, fresh >>= 1)
+    {
+        if (fresh & 1) since[i] = now;
+    }
+
+    stamped |= pending;
+}
@@ -0,0 +1,68 @@
+
+#ifndef GPIOInput_H
+#define GPIOInput_H
+
+#define GPIO_COUNT              8
+#define GPIO_PORTS              5           // LPC1768 GPIO ports 0..4
+#define GPIO_TICK_US            1500        // debounce tick - DEBOUNCE_SAMPLES ticks = 10.5 ms
+#define GPIO_MAIL_SIZE          16          // events waiting for the main loop
+
+#include "mbed.h"
+#include "rtos.h"
+#include "us_ticker_api.h"
+#include "Debouncer.h"
+
+//**************************************************************************
+//GPIO EVENT
+//**************************************************************************
+struct GPIOEvent
+{
+    unsigned char pin;                      // 1 .. GPIO_COUNT
+    unsigned char level;                    // debounced level - 0 = pressed (pull-up)
+    unsigned int time_us;                   // edge that started the new level
+};
+
+//**************************************************************************
+//GPIO INPUT
+//**************************************************************************
+// Debounces the GPIO inputs from a Ticker, one port register read per tick, and posts each
+// change with the time of its edge. InterruptIn (ports 0 & 2 only) stamps the edges.
+class GPIOInput
+{
+public:
+    GPIOInput(const PinName* pins, unsigned int edgeMask);
+
+    void start();
+    bool get(GPIOEvent* event, unsigned int timeout_ms);
+
+    int read(int pin) { return (debouncer.state() >> (pin - 1)) & 1; }
+    unsigned int state() { return debouncer.state(); }
+
+    unsigned long edges;                    // edge interrupts
+    unsigned long lost;                     // events dropped on a full mailbox
+
+private:
+    void edge();
+    void tick();
+    unsigned int sample();
+    void stamp(unsigned int pending, unsigned int now);
+
+    const PinName* pins;
+    unsigned int edgeMask;
+
+    DigitalIn* input[GPIO_COUNT];           // pin configuration only - levels come from the port registers
+    InterruptIn* edgeIn[GPIO_COUNT];
+    Ticker ticker;
+    Mail<GPIOEvent, GPIO_MAIL_SIZE> mail;
+    Debouncer debouncer;
+
+    LPC_GPIO_TypeDef* port[GPIO_PORTS];     // ports used by the pins
+    int portCount;
+    unsigned char pinPort[GPIO_COUNT];      // index into port
+    unsigned char pinBit[GPIO_COUNT];       // bit in the port register
+
+    unsigned int stamped;                   // pins with a pending change & timestamp
+    unsigned int since[GPIO_COUNT];
+};
+
+#endif
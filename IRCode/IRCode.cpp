@@ -0,0 +1,282 @@
+#include "IRCode.h"
+#include "mbed.h"
+
+
+//**************************************************************************
+//PRONTO DECODER
+//**************************************************************************
+static int hexDigit(char c)
+{
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    if ((c >= 'A') && (c <= 'F')) return c - 'A' + 10;
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    return -1;
+}
+
+bool parseProntoCode(const char* ptrIRCode, unsigned short* timing, int maxPairs, IRCode* code)
+{
+    unsigned short header[4];
+    unsigned int value;
+    int digits;
+    int digit;
+    int index = 0;
+    int timingCount = 0;
+    int pairCount;
+
+    code->protocol = IR_PROTOCOL_PRONTO;
+    code->carrier = 0;
+    code->onceCount = 0;
+    code->repeatCount = 0;
+    code->timing = timing;
+    code->address = 0;
+    code->command = 0;
+
+    while (true)
+    {
+        //Skip delimiters
+        while ((*ptrIRCode == ' ') || (*ptrIRCode == '\t')) ptrIRCode++;
+        if ((*ptrIRCode == 0) || (*ptrIRCode == '\r') || (*ptrIRCode == '\n')) break;
+
+        //Hex word - at most 4 digits
+        value = 0;
+        digits = 0;
+        while ((digit = hexDigit(*ptrIRCode)) >= 0)
+        {
+            if (++digits > 4) return false;
+            value = (value << 4) | digit;
+            ptrIRCode++;
+        }
+        if (digits == 0) return false;
+
+        //Header: format, carrier, once pair count, repeat pair count
+        if (index < 4)
+        {
+            header[index] = value;
+        }
+
+        //On/off times in carrier cycles
+        else
+        {
+            if (timingCount == 2 * maxPairs) return false;
+            timing[timingCount++] = value;
+        }
+
+        index++;
+    }
+
+    //Raw (learned) codes only
+    if ((index < 4) || (header[0] != 0x0000) || (header[1] == 0)) return false;
+
+    //Once & repeat sequences must be complete
+    pairCount = header[2] + header[3];
+    if ((pairCount == 0) || (pairCount > maxPairs) || (2 * pairCount > timingCount)) return false;
+
+    code->carrier = header[1];
+    code->onceCount = header[2];
+    code->repeatCount = header[3];
+
+    return true;
+}
+
+//**************************************************************************
+//PROTOCOL DECODER
+//**************************************************************************
+struct ProtocolName
+{
+    const char* name;
+    unsigned char protocol;
+    unsigned short carrier;             // Pronto carrier word
+    unsigned short maxAddress;
+    unsigned short maxCommand;
+};
+
+static const ProtocolName protocolNames[] =
+{
+    //name      protocol                carrier         address     command
+    { "NEC",    IR_PROTOCOL_NEC,        0x006D,         0xFFFF,     0xFF },     // 38 kHz
+    { "RC5",    IR_PROTOCOL_RC5,        0x0073,         0x1F,       0x7F },     // 36 kHz
+    { "RC6",    IR_PROTOCOL_RC6,        0x0073,         0xFF,       0xFF },     // 36 kHz
+    { "SIRC12", IR_PROTOCOL_SIRC12,     0x0068,         0x1F,       0x7F },     // 40 kHz
+    { "SIRC15", IR_PROTOCOL_SIRC15,     0x0068,         0xFF,       0x7F },     // 40 kHz
+    { "SIRC20", IR_PROTOCOL_SIRC20,     0x0068,         0x1FFF,     0x7F },     // 40 kHz
+    { "SIRC",   IR_PROTOCOL_SIRC12,     0x0068,         0x1F,       0x7F },     // 40 kHz
+};
+
+bool parseProtocolCode(const char* ptrIRCode, IRCode* code)
+{
+    const ProtocolName* entry = NULL;
+    unsigned int value[2];
+    int digits;
+    int digit;
+    int length;
+
+    //Skip delimiters
+    while ((*ptrIRCode == ' ') || (*ptrIRCode == '\t')) ptrIRCode++;
+
+    //Protocol name
+    for (unsigned int i = 0; i < sizeof protocolNames / sizeof protocolNames[0]; i++)
+    {
+        length = strlen(protocolNames[i].name);
+        if ((strncmp(ptrIRCode, protocolNames[i].name, length) == 0) && ((ptrIRCode[length] == ' ') || (ptrIRCode[length] == '\t')))
+        {
+            entry = &protocolNames[i];
+            ptrIRCode += length;
+            break;
+        }
+    }
+    if (entry == NULL) return false;
+
+    //Address & command - hex words
+    for (int i = 0; i < 2; i++)
+    {
+        while ((*ptrIRCode == ' ') || (*ptrIRCode == '\t')) ptrIRCode++;
+
+        value[i] = 0;
+        digits = 0;
+        while ((digit = hexDigit(*ptrIRCode)) >= 0)
+        {
+            if (++digits > 4) return false;
+            value[i] = (value[i] << 4) | digit;
+            ptrIRCode++;
+        }
+        if (digits == 0) return false;
+    }
+
+    //Nothing else on the line
+    while ((*ptrIRCode == ' ') || (*ptrIRCode == '\t')) ptrIRCode++;
+    if ((*ptrIRCode != 0) && (*ptrIRCode != '\r') && (*ptrIRCode != '\n')) return false;
+
+    if ((value[0] > entry->maxAddress) || (value[1] > entry->maxCommand)) return false;
+
+    code->protocol = entry->protocol;
+    code->carrier = entry->carrier;
+    code->onceCount = 0;
+    code->repeatCount = 0;
+    code->timing = NULL;
+    code->address = value[0];
+    code->command = value[1];
+
+    return true;
+}
+
+bool parseIRCode(const char* ptrIRCode, unsigned short* timing, int maxPairs, IRCode* code)
+{
+    if (parseProtocolCode(ptrIRCode, code)) return true;
+
+    return parseProntoCode(ptrIRCode, timing, maxPairs, code);
+}
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+IRCodeCache::IRCodeCache()
+{
+    hits = 0;
+    misses = 0;
+
+    clear();
+}
+
+//**************************************************************************
+//LOAD
+//**************************************************************************
+void IRCodeCache::clear()
+{
+    poolUsed = 0;
+    entryUsed = 0;
+
+    for(int i = 0; i < IR_PORT_COUNT; i++)
+    {
+        portFirst[i] = 0;
+        portCount[i] = 0;
+    }
+}
+
+// Compile every line of an IR file into the cache - returns the number of lines, find() misses those left out
+int IRCodeCache::load(int port, const char* path, char* lineBuffer, int lineSize)
+{
+    FILE* file;
+    IRCode code;
+    int index = port - 1;
+    int maxPairs;
+
+    if ((index < 0) || (index >= IR_PORT_COUNT)) return 0;
+
+    portFirst[index] = entryUsed;
+    portCount[index] = 0;
+
+    //Open the file
+    file = fopen(path, "r");
+    if (file == NULL) return 0;
+
+    //One entry per line, so line n stays entry n - a Pronto code the pool has no room for is left to the slow path
+    while ((entryUsed < IR_CACHE_ENTRIES) && (portCount[index] < 255))
+    {
+        if (fgets(lineBuffer, lineSize, file) == NULL) break;
+
+        maxPairs = (IR_CACHE_SIZE - poolUsed) / 2;
+        if (maxPairs > IR_MAX_PAIRS) maxPairs = IR_MAX_PAIRS;
+
+        Entry& e = entry[entryUsed];
+        e.offset = poolUsed;
+        e.carrier = 0;
+        e.onceCount = 0;
+        e.repeatCount = 0;
+        e.protocol = IR_PROTOCOL_PRONTO;
+        e.address = 0;
+        e.command = 0;
+
+        //Decode straight into the pool - protocol codes take no pool space, so they are cached once it is full too
+        if (parseIRCode(lineBuffer, pool + poolUsed, maxPairs, &code))
+        {
+            e.carrier = code.carrier;
+            e.onceCount = code.onceCount;
+            e.repeatCount = code.repeatCount;
+            e.protocol = code.protocol;
+            e.address = code.address;
+            e.command = code.command;
+            poolUsed += 2 * code.pairCount();
+        }
+
+        entryUsed++;
+        portCount[index]++;
+    }
+
+    //Close the file
+    fclose(file);
+
+    return portCount[index];
+}
+
+//**************************************************************************
+//FIND
+//**************************************************************************
+bool IRCodeCache::find(int port, int channel, IRCode* code)
+{
+    int index = port - 1;
+
+    if ((index < 0) || (index >= IR_PORT_COUNT) || (channel < 1) || (channel > portCount[index]))
+    {
+        misses++;
+        return false;
+    }
+
+    Entry& e = entry[portFirst[index] + channel - 1];
+
+    if ((e.protocol == IR_PROTOCOL_PRONTO) && ((e.onceCount + e.repeatCount) == 0))
+    {
+        misses++;
+        return false;
+    }
+
+    code->protocol = e.protocol;
+    code->carrier = e.carrier;
+    code->onceCount = e.onceCount;
+    code->repeatCount = e.repeatCount;
+    code->timing = pool + e.offset;
+    code->address = e.address;
+    code->command = e.command;
+
+    hits++;
+    return true;
+}
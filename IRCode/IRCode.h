@@ -0,0 +1,93 @@
+
+#ifndef IRCode_H
+#define IRCode_H
+
+#define IR_PORT_COUNT       6
+#define IR_MAX_PAIRS        128
+#define IR_CACHE_SIZE       2048        // timing words shared by all cached codes
+#define IR_CACHE_ENTRIES    96          // cached codes (file lines) over all ports
+
+#define IR_PROTOCOL_PRONTO  0           // raw on/off pairs from the IR file
+#define IR_PROTOCOL_NEC     1           // 38 kHz, 8/16 bit address, 8 bit command
+#define IR_PROTOCOL_RC5     2           // 36 kHz, 5 bit address, 7 bit command (RC5X)
+#define IR_PROTOCOL_RC6     3           // 36 kHz, mode 0, 8 bit address, 8 bit command
+#define IR_PROTOCOL_SIRC12  4           // 40 kHz, 5 bit address, 7 bit command
+#define IR_PROTOCOL_SIRC15  5           // 40 kHz, 8 bit address, 7 bit command
+#define IR_PROTOCOL_SIRC20  6           // 40 kHz, 5 bit address + 8 bit extended, 7 bit command
+
+//**************************************************************************
+//IR CODE
+//**************************************************************************
+// One IR code as on/off pairs counted in carrier cycles. Pronto stores the
+// same values, so a code is kept as 2 bytes per mark/space regardless of
+// how long the line was in the IR file. The repeat sequence follows the
+// once sequence in timing.
+// Codes of a known protocol carry only address & command and no timing -
+// IRSequence generates their marks and spaces while they are sent.
+struct IRCode
+{
+    unsigned char protocol;             // IR_PROTOCOL_xxx
+    unsigned short carrier;             // Pronto carrier word - period = carrier * 0.241246 us
+    unsigned char onceCount;            // on/off pairs sent once
+    unsigned char repeatCount;          // on/off pairs sent on every repeat
+    const unsigned short* timing;       // on, off, on, off ... in carrier cycles
+    unsigned short address;             // protocol codes only
+    unsigned short command;
+
+    int pairCount() const { return onceCount + repeatCount; }
+    bool valid() const { return (protocol != IR_PROTOCOL_PRONTO) || (pairCount() > 0); }
+};
+
+//Decode one raw Pronto hex line ("0000 carrier once repeat pairs...") into timing (2 * maxPairs words)
+//false if the line is not a complete raw Pronto code or does not fit
+bool parseProntoCode(const char* ptrIRCode, unsigned short* timing, int maxPairs, IRCode* code);
+
+//Decode one protocol line ("NEC address command", hex) - false if it is not one
+bool parseProtocolCode(const char* ptrIRCode, IRCode* code);
+
+//Decode one IR file line of either kind
+bool parseIRCode(const char* ptrIRCode, unsigned short* timing, int maxPairs, IRCode* code);
+
+//**************************************************************************
+//IR CODE CACHE
+//**************************************************************************
+// Codes of the /local/IRn.txt files compiled into RAM at boot. Line n of
+// port p is entry portFirst[p] + n - 1, so a lookup is one index.
+class IRCodeCache
+{
+public:
+    IRCodeCache();
+
+    void clear();
+    int load(int port, const char* path, char* lineBuffer, int lineSize);
+    bool find(int port, int channel, IRCode* code);
+
+    int entries() { return entryUsed; }
+    int size() { return poolUsed; }
+    int capacity() { return IR_CACHE_SIZE; }
+
+    unsigned long hits;
+    unsigned long misses;
+
+private:
+    struct Entry
+    {
+        unsigned short offset;
+        unsigned short carrier;
+        unsigned char onceCount;
+        unsigned char repeatCount;
+        unsigned char protocol;
+        unsigned short address;
+        unsigned short command;
+    };
+
+    unsigned short pool[IR_CACHE_SIZE];
+    Entry entry[IR_CACHE_ENTRIES];
+    unsigned char portFirst[IR_PORT_COUNT];
+    unsigned char portCount[IR_PORT_COUNT];
+
+    int poolUsed;
+    int entryUsed;
+};
+
+#endif
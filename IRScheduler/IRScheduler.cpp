@@ -0,0 +1,156 @@
+#include "IRScheduler.h"
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+IRScheduler::IRScheduler(IRTransmitter** transmitters) : transmitter(transmitters)
+{
+    carrier = 0;
+
+    for (int i = 0; i < IR_PORT_COUNT; i++)
+    {
+        head[i] = 0;
+        count[i] = 0;
+        maxDepth[i] = 0;
+        lastLatency_us[i] = 0;
+        maxLatency_us[i] = 0;
+
+        // attach the completion interrupts
+        transmitter[i]->attach(this, &IRScheduler::done);
+    }
+}
+
+//**************************************************************************
+//SEND
+//**************************************************************************
+// Queue a code on a port - false if the port queue is full
+bool IRScheduler::send(int port, const IRCode& code, int repeat)
+{
+    int index = port - 1;
+    Request* request;
+
+    if ((index < 0) || (index >= IR_PORT_COUNT)) return false;
+
+    // Start Critical Section - the completion interrupt also walks the queues
+    __disable_irq();
+
+        if (count[index] == IR_QUEUE_SIZE)
+        {
+            __enable_irq();
+            return false;
+        }
+
+        //Set Request
+        request = &queue[index][(head[index] + count[index]) % IR_QUEUE_SIZE];
+        request->code = code;
+        request->repeat = repeat;
+        request->queued_us = us_ticker_read();
+
+        count[index]++;
+        if (count[index] > maxDepth[index]) maxDepth[index] = count[index];
+
+        //Start it now if the carrier allows
+        start();
+
+    // End Critical Section
+    __enable_irq();
+
+    return true;
+}
+
+// End the holds of a port - the running one and any still queued
+void IRScheduler::release(int port)
+{
+    int index = port - 1;
+
+    if ((index < 0) || (index >= IR_PORT_COUNT)) return;
+
+    // Start Critical Section
+    __disable_irq();
+
+        for (int i = 0; i < count[index]; i++)
+        {
+            Request* request = &queue[index][(head[index] + i) % IR_QUEUE_SIZE];
+            if (request->repeat == IR_REPEAT_HOLD) request->repeat = 1;
+        }
+
+        transmitter[index]->release();
+
+    // End Critical Section
+    __enable_irq();
+}
+
+bool IRScheduler::idle()
+{
+    for (int i = 0; i < IR_PORT_COUNT; i++)
+    {
+        if ((count[i] != 0) || transmitter[i]->busy()) return false;
+    }
+
+    return true;
+}
+
+//**************************************************************************
+//START
+//**************************************************************************
+// Start every queued code that fits the running carrier - called with interrupts disabled
+void IRScheduler::start()
+{
+    bool active = false;
+    int oldest = -1;
+    unsigned int now = us_ticker_read();
+    Request* request;
+
+    //Running carrier & oldest waiting code
+    for (int i = 0; i < IR_PORT_COUNT; i++)
+    {
+        if (transmitter[i]->busy()) active = true;
+
+        if ((count[i] != 0) && !transmitter[i]->busy())
+        {
+            request = &queue[i][head[i]];
+            if ((oldest < 0) || ((int)(now - request->queued_us) > (int)(now - queue[oldest][head[oldest]].queued_us))) oldest = i;
+        }
+    }
+
+    //Nothing to start
+    if (oldest < 0) return;
+
+    //Carrier change - wait until every port is idle
+    if (!active) carrier = queue[oldest][head[oldest]].code.carrier;
+    else if (!compatible(queue[oldest][head[oldest]].code.carrier, carrier)) return;
+
+    //Start all free ports on the running carrier
+    for (int i = 0; i < IR_PORT_COUNT; i++)
+    {
+        if ((count[i] == 0) || transmitter[i]->busy()) continue;
+
+        request = &queue[i][head[i]];
+        if (!compatible(request->code.carrier, carrier)) continue;
+
+        //Latency
+        lastLatency_us[i] = now - request->queued_us;
+        if (lastLatency_us[i] > maxLatency_us[i]) maxLatency_us[i] = lastLatency_us[i];
+
+        //Send
+        transmitter[i]->send(request->code, request->repeat);
+
+        //Next request
+        head[i] = (head[i] + 1) % IR_QUEUE_SIZE;
+        count[i]--;
+    }
+}
+
+// Interupt Routine - a transmitter finished its code
+void IRScheduler::done()
+{
+    start();
+}
+
+bool IRScheduler::compatible(unsigned short a, unsigned short b)
+{
+    int difference = (a > b) ? (a - b) : (b - a);
+
+    return (difference * 100) <= (b * IR_CARRIER_TOLERANCE);
+}
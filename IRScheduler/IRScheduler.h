@@ -0,0 +1,63 @@
+
+#ifndef IRScheduler_H
+#define IRScheduler_H
+
+#define IR_QUEUE_SIZE           4           // pending codes per port
+#define IR_CARRIER_TOLERANCE    3           // % difference still sent on a shared carrier
+
+#include "mbed.h"
+#include "us_ticker_api.h"
+#include "IRCode.h"
+#include "IRTransmitter.h"
+
+//**************************************************************************
+//IR SCHEDULER
+//**************************************************************************
+// All PwmOut pins of the LPC1768 share one period register, so codes on
+// several ports can only be on the air together when their carriers match.
+// The scheduler keeps a queue per port and starts every queued code whose
+// carrier fits the one already running; a code with another carrier waits
+// until all ports are idle. Once the oldest waiting code needs another
+// carrier, no new code is started on the running one, so it cannot starve.
+class IRScheduler
+{
+public:
+    IRScheduler(IRTransmitter** transmitters);
+
+    bool send(int port, const IRCode& code, int repeat);
+    bool idle();
+    bool idle(int port) { return (count[port - 1] == 0) && !transmitter[port - 1]->busy(); }
+
+    void hold(int port) { transmitter[port - 1]->hold(); }
+    void release(int port);
+    bool holding(int port) { return transmitter[port - 1]->holding(); }
+
+    int queued(int port) { return count[port - 1]; }
+    bool busy(int port) { return transmitter[port - 1]->busy(); }
+
+    unsigned char maxDepth[IR_PORT_COUNT];
+    unsigned long lastLatency_us[IR_PORT_COUNT];    // queued -> first mark
+    unsigned long maxLatency_us[IR_PORT_COUNT];
+
+private:
+    struct Request
+    {
+        IRCode code;
+        int repeat;
+        unsigned int queued_us;
+    };
+
+    void start();
+    void done();
+    bool compatible(unsigned short a, unsigned short b);
+
+    IRTransmitter** transmitter;
+
+    Request queue[IR_PORT_COUNT][IR_QUEUE_SIZE];
+    unsigned char head[IR_PORT_COUNT];
+    unsigned char count[IR_PORT_COUNT];
+
+    unsigned short carrier;                     // carrier of the ports on the air
+};
+
+#endif
@@ -0,0 +1,242 @@
+#include "IRSequence.h"
+#include "mbed.h"
+
+#define NEC_PERIOD_US       108000
+#define RC5_PERIOD_US       113778
+#define RC6_PERIOD_US       107000
+#define SIRC_PERIOD_US      45000
+
+#define RC5_UNIT_US         889         // half bit
+#define RC6_UNIT_US         444         // half bit, trailer bit is twice as long
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+IRSequence::IRSequence()
+{
+    code = NULL;
+    repeatFrame = false;
+    index = 0;
+    end = 0;
+    elapsed_us = 0;
+    period_us = 0;
+
+    period_q4 = 0;
+    data = 0;
+    bits = 0;
+
+    levels = 0;
+    unitCount = 0;
+    unit = 0;
+    unit_us = 0;
+
+    toggle = false;
+}
+
+//**************************************************************************
+//START
+//**************************************************************************
+// Begin a frame - the first frame of a code or one of its repeats
+void IRSequence::start(const IRCode* code, bool repeatFrame)
+{
+    int field;
+
+    this->code = code;
+    this->repeatFrame = repeatFrame;
+    index = 0;
+    elapsed_us = 0;
+
+    switch (code->protocol)
+    {
+        //Once & repeat sequence, then the repeat sequence only (or the whole code if there is none)
+        case IR_PROTOCOL_PRONTO:
+            period_us = 0;
+            period_q4 = (code->carrier * 3860) / 1000;
+            if (repeatFrame && (code->repeatCount > 0)) index = 2 * code->onceCount;
+            end = 2 * code->pairCount();
+            break;
+
+        //Address, inverted address (or 16 bit address), command, inverted command - repeats are the short repeat frame
+        case IR_PROTOCOL_NEC:
+            period_us = NEC_PERIOD_US;
+            data = (code->address > 0xFF) ? code->address : (code->address | ((~code->address & 0xFF) << 8));
+            data |= ((unsigned long)code->command << 16) | ((unsigned long)(~code->command & 0xFF) << 24);
+            end = repeatFrame ? 4 : 68;
+            break;
+
+        //Command, then address - repeats are full frames
+        case IR_PROTOCOL_SIRC12:
+        case IR_PROTOCOL_SIRC15:
+        case IR_PROTOCOL_SIRC20:
+            period_us = SIRC_PERIOD_US;
+            bits = (code->protocol == IR_PROTOCOL_SIRC12) ? 12 : (code->protocol == IR_PROTOCOL_SIRC15) ? 15 : 20;
+            data = code->command | ((unsigned long)code->address << 7);
+            end = 2 + 2 * bits;
+            break;
+
+        //Start bits, toggle, 5 address bits, 6 command bits - the second start bit is the inverted 7th command bit (RC5X)
+        case IR_PROTOCOL_RC5:
+            if (!repeatFrame) toggle = !toggle;
+            period_us = RC5_PERIOD_US;
+            unit_us = RC5_UNIT_US;
+            levels = 0;
+            unitCount = 0;
+            field = (1 << 13) | (((code->command & 0x40) ? 0 : 1) << 12) | ((toggle ? 1 : 0) << 11) | ((code->address & 0x1F) << 6) | (code->command & 0x3F);
+            for (int i = 13; i >= 0; i--) appendBit(((field >> i) & 1) == 0, 1);
+            end = unitCount + 1;
+            break;
+
+        //Leader, start bit, mode 0, double length toggle, 8 address bits, 8 command bits
+        case IR_PROTOCOL_RC6:
+            if (!repeatFrame) toggle = !toggle;
+            period_us = RC6_PERIOD_US;
+            unit_us = RC6_UNIT_US;
+            levels = 0;
+            unitCount = 0;
+            append(1, 6);
+            append(0, 2);
+            appendBit(true, 1);
+            for (int i = 0; i < 3; i++) appendBit(false, 1);
+            appendBit(toggle, 2);
+            field = (code->address << 8) | code->command;
+            for (int i = 15; i >= 0; i--) appendBit(((field >> i) & 1) != 0, 1);
+            end = unitCount + 1;
+            break;
+
+        default:
+            end = 0;
+            break;
+    }
+
+    //Bi-phase frames may begin with a space half bit - the frame starts at the first mark
+    unit = 0;
+    if ((code->protocol == IR_PROTOCOL_RC5) || (code->protocol == IR_PROTOCOL_RC6))
+    {
+        while ((unit < unitCount) && !((levels >> unit) & 1)) unit++;
+    }
+}
+
+//**************************************************************************
+//NEXT
+//**************************************************************************
+// Duration of the next mark/space - marks on even steps - false at the end of the frame
+bool IRSequence::next(unsigned int* duration_us)
+{
+    if ((code == NULL) || (index >= end)) return false;
+
+    switch (code->protocol)
+    {
+        case IR_PROTOCOL_PRONTO:
+            *duration_us = (code->timing[index] * period_q4) >> 4;
+            break;
+
+        case IR_PROTOCOL_NEC:
+            *duration_us = pulseDistance();
+            break;
+
+        case IR_PROTOCOL_SIRC12:
+        case IR_PROTOCOL_SIRC15:
+        case IR_PROTOCOL_SIRC20:
+            *duration_us = pulseWidth();
+            break;
+
+        default:
+            *duration_us = biPhase();
+            break;
+    }
+
+    index++;
+    elapsed_us += *duration_us;
+
+    return true;
+}
+
+//**************************************************************************
+//ENCODERS
+//**************************************************************************
+// NEC - 560 us marks, the space carries the bit
+unsigned int IRSequence::pulseDistance()
+{
+    if (repeatFrame)
+    {
+        switch (index)
+        {
+            case 0:  return 9000;
+            case 1:  return 2250;
+            case 2:  return 560;
+            default: return gap(560);
+        }
+    }
+
+    if (index == 0) return 9000;
+    if (index == 1) return 4500;
+    if (index == end - 1) return gap(560);
+    if ((index & 1) == 0) return 560;
+
+    return ((data >> ((index - 3) / 2)) & 1) ? 1690 : 560;
+}
+
+// SIRC - 600 us spaces, the mark carries the bit
+unsigned int IRSequence::pulseWidth()
+{
+    if (index == 0) return 2400;
+    if (index == end - 1) return gap(600);
+    if (index & 1) return 600;
+
+    return ((data >> ((index - 2) / 2)) & 1) ? 1200 : 600;
+}
+
+// RC5 & RC6 - one run of equal levels per step
+unsigned int IRSequence::biPhase()
+{
+    unsigned int level;
+    int run = 0;
+
+    //Frame ended on a mark - trailing space
+    if (unit >= unitCount)
+    {
+        end = index + 1;
+        return gap(0);
+    }
+
+    level = (levels >> unit) & 1;
+    while ((unit < unitCount) && ((unsigned int)((levels >> unit) & 1) == level))
+    {
+        run++;
+        unit++;
+    }
+
+    //Frame ended on a space - stretch it
+    if ((unit >= unitCount) && (level == 0))
+    {
+        end = index + 1;
+        return gap(run * unit_us);
+    }
+
+    return run * unit_us;
+}
+
+// Last space of a frame - fill up to the frame period
+unsigned int IRSequence::gap(unsigned int duration_us)
+{
+    if (elapsed_us + duration_us < period_us) return period_us - elapsed_us;
+
+    return duration_us;
+}
+
+void IRSequence::append(int level, int units)
+{
+    for (int i = 0; i < units; i++)
+    {
+        if (level) levels |= (1ULL << unitCount);
+        unitCount++;
+    }
+}
+
+// One bi-phase bit as two halves of units each
+void IRSequence::appendBit(bool markFirst, int units)
+{
+    append(markFirst ? 1 : 0, units);
+    append(markFirst ? 0 : 1, units);
+}
@@ -0,0 +1,52 @@
+
+#ifndef IRSequence_H
+#define IRSequence_H
+
+#include "IRCode.h"
+
+//**************************************************************************
+//IR SEQUENCE
+//**************************************************************************
+// Walks the marks and spaces of one frame of an IRCode, one duration per
+// call, so the transmitter interrupt never needs a timing table for
+// protocol codes. Pronto codes are read from their timing table; NEC and
+// SIRC durations follow from the step index, RC5/RC6 bi-phase bits are
+// expanded into a level bit mask at the frame start and read as runs.
+// The last space of a frame is stretched to the protocol frame period.
+class IRSequence
+{
+public:
+    IRSequence();
+
+    void start(const IRCode* code, bool repeatFrame);
+    bool next(unsigned int* duration_us);
+
+private:
+    unsigned int pulseDistance();
+    unsigned int pulseWidth();
+    unsigned int biPhase();
+    unsigned int gap(unsigned int duration_us);
+
+    void append(int level, int units);
+    void appendBit(bool markFirst, int units);
+
+    const IRCode* code;
+    bool repeatFrame;
+    int index;                          // step in the frame
+    int end;                            // steps of the frame
+    unsigned int elapsed_us;            // since the frame started
+    unsigned int period_us;             // frame period, 0 for Pronto
+
+    unsigned int period_q4;             // Pronto: carrier period in 1/16 us
+    unsigned long data;                 // NEC & SIRC: bits sent LSB first
+    int bits;
+
+    unsigned long long levels;          // RC5 & RC6: one bit per time unit, 1 = mark
+    int unitCount;
+    int unit;
+    unsigned int unit_us;
+
+    bool toggle;                        // RC5 & RC6: flips on every new code
+};
+
+#endif
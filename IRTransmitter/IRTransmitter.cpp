@@ -0,0 +1,106 @@
+#include "IRTransmitter.h"
+
+unsigned short IRTransmitter::pwmCarrier = 0;
+volatile int IRTransmitter::activeCount = 0;
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+IRTransmitter::IRTransmitter(PwmOut& pwm) : pwm(pwm)
+{
+    sent = 0;
+    maxError_us = 0;
+    lastError_us = 0;
+
+    repeat = 0;
+    mark = false;
+    deadline = 0;
+
+    active = false;
+    held = false;
+    holdUntil = 0;
+}
+
+//**************************************************************************
+//SEND
+//**************************************************************************
+bool IRTransmitter::send(const IRCode& code, int repeat)
+{
+    if (active || !code.valid() || (repeat <= 0)) return false;
+
+    //Set code
+    this->code = code;
+    this->repeat = (repeat == IR_REPEAT_HOLD) ? 1 : repeat;
+    held = (repeat == IR_REPEAT_HOLD);
+    hold();
+    sequence.start(&this->code, false);
+    mark = true;
+    lastError_us = 0;
+
+    //Set PWM Period - Pronto carrier word * 0.241246 us - Note: If you change one of the ports, all of them will change
+    if ((activeCount == 0) && (code.carrier != pwmCarrier))
+    {
+        pwm.period(code.carrier * 0.241246e-6f);
+        pwmCarrier = code.carrier;
+    }
+
+    //Start with the first mark
+    active = true;
+    activeCount++;
+    deadline = us_ticker_read();
+    step();
+
+    return true;
+}
+
+//**************************************************************************
+//STEP
+//**************************************************************************
+// Timeout interrupt routine - ends the current mark/space and starts the next
+void IRTransmitter::step()
+{
+    unsigned int error;
+    unsigned int duration;
+    int remaining;
+
+    //Measure how late this edge is
+    error = us_ticker_read() - deadline;
+    if (error > lastError_us) lastError_us = error;
+    if (error > maxError_us) maxError_us = error;
+
+    //End of frame - next repeat sends the repeat frame, a held code repeats until released
+    if (!sequence.next(&duration))
+    {
+        if (held && ((int)(us_ticker_read() - holdUntil) >= 0)) held = false;
+        if (!held) repeat--;
+
+        if (repeat > 0)
+        {
+            sequence.start(&code, true);
+            sequence.next(&duration);
+            mark = true;
+        }
+    }
+
+    //Done
+    if (repeat == 0)
+    {
+        pwm.write(0.0f);
+        active = false;
+        activeCount--;
+        sent++;
+        done.call();
+        return;
+    }
+
+    //Mark & space alternate
+    pwm.write(mark ? IR_DUTY : 0.0f);
+    mark = !mark;
+
+    //Next deadline - from the last deadline, not the interrupt entry, so latency does not add up
+    deadline += duration;
+
+    remaining = deadline - us_ticker_read();
+    if (remaining < IR_MIN_STEP_US) remaining = IR_MIN_STEP_US;
+    timeout.attach_us(this, &IRTransmitter::step, remaining);
+}
@@ -0,0 +1,62 @@
+
+#ifndef IRTransmitter_H
+#define IRTransmitter_H
+
+#define IR_MIN_STEP_US      4           // never arm the timer in the past
+#define IR_DUTY             0.5f
+#define IR_REPEAT_HOLD      0xFF        // repeat until released
+#define IR_HOLD_TIMEOUT_US  1000000     // a hold ends unless refreshed or released within this
+
+#include "mbed.h"
+#include "us_ticker_api.h"
+#include "IRCode.h"
+#include "IRSequence.h"
+
+//**************************************************************************
+//IR TRANSMITTER
+//**************************************************************************
+// Sends one IRCode on a PwmOut from the us ticker interrupt without blocking the caller.
+// The code's timing table must stay valid until the transmission is done.
+class IRTransmitter
+{
+public:
+    IRTransmitter(PwmOut& pwm);
+
+    bool send(const IRCode& code, int repeat);
+    bool busy() { return active; }
+
+    void hold() { holdUntil = us_ticker_read() + IR_HOLD_TIMEOUT_US; }
+    void release() { held = false; }
+    bool holding() { return active && held; }
+
+    // Completion callback - called from interrupt context
+    void attach(void (*function)(void)) { done.attach(function); }
+    template<typename T>
+    void attach(T* object, void (T::*member)(void)) { done.attach(object, member); }
+
+    unsigned long sent;
+    unsigned long maxError_us;          // worst late edge seen
+    unsigned long lastError_us;         // worst late edge of the last code
+
+private:
+    void step();
+
+    PwmOut& pwm;
+    Timeout timeout;
+    FunctionPointer done;
+
+    IRCode code;
+    IRSequence sequence;
+    int repeat;
+    bool mark;                          // next step starts a mark
+    unsigned int deadline;
+
+    volatile bool active;
+    volatile bool held;
+    volatile unsigned int holdUntil;
+
+    static unsigned short pwmCarrier;
+    static volatile int activeCount;
+};
+
+#endif
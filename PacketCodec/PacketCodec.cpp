@@ -0,0 +1,102 @@
+#include "PacketCodec.h"
+
+
+//**************************************************************************
+//CHECKSUM
+//**************************************************************************
+char packetChecksum(const char* buffer, int length)
+{
+    char checksum = 0;
+
+    for(int i = 0; i < length; i++)
+    {
+        checksum = checksum + buffer[i];
+    }
+
+    return checksum;
+}
+
+//**************************************************************************
+//DECODE
+//**************************************************************************
+bool packetDecode(const char* buffer, int bufferLength, PacketFrame* packet)
+{
+    int packetLength;
+
+    //Check header
+    if(bufferLength < PACKET_OVERHEAD) return false;
+    if(buffer[0] != PACKET_START) return false;
+
+    //Check length
+    packetLength = (unsigned char)buffer[4] + PACKET_OVERHEAD;
+    if(packetLength > bufferLength || packetLength > PACKET_MAX_SIZE) return false;
+
+    //Check checksum
+    if(packetChecksum(buffer, packetLength - 1) != buffer[packetLength - 1]) return false;
+
+    //Set view
+    packet->frame = buffer;
+    packet->deviceID = buffer[1];
+    packet->dataType = buffer[2];
+    packet->channel = buffer[3];
+    packet->dataLength = (unsigned char)buffer[4];
+    packet->data = buffer + PACKET_HEADER_SIZE;
+
+    return true;
+}
+
+//**************************************************************************
+//BATCH
+//**************************************************************************
+bool packetBatchNext(const PacketFrame& batch, int* offset, PacketFrame* command)
+{
+    const char* subCommand = batch.data + *offset;
+    int remaining = batch.dataLength - *offset;
+    int dataLength;
+
+    //Check sub-command header
+    if(remaining < PACKET_BATCH_HEADER_SIZE) return false;
+
+    //Check sub-command length
+    dataLength = (unsigned char)subCommand[2];
+    if(PACKET_BATCH_HEADER_SIZE + dataLength > remaining) return false;
+
+    //Set view - sub-commands inherit the device ID of the batch
+    command->frame = subCommand;
+    command->deviceID = batch.deviceID;
+    command->dataType = subCommand[0];
+    command->channel = subCommand[1];
+    command->dataLength = dataLength;
+    command->data = subCommand + PACKET_BATCH_HEADER_SIZE;
+
+    //Next sub-command
+    *offset = *offset + PACKET_BATCH_HEADER_SIZE + dataLength;
+
+    return true;
+}
+
+//**************************************************************************
+//ENCODE
+//**************************************************************************
+int packetEncode(char* buffer, char deviceID, char dataType, char channel, const char* data, int dataLength)
+{
+    if(dataLength < 0 || dataLength > PACKET_MAX_DATA) return 0;
+
+    //Header
+    buffer[0] = PACKET_START;
+    buffer[1] = deviceID;
+    buffer[2] = dataType;
+    buffer[3] = channel;
+    buffer[4] = dataLength;
+
+    //Data
+    for(int i = 0; i < dataLength; i++)
+    {
+        buffer[PACKET_HEADER_SIZE + i] = data[i];
+    }
+
+    //Checksum
+    buffer[PACKET_HEADER_SIZE + dataLength] = packetChecksum(buffer, PACKET_HEADER_SIZE + dataLength);
+
+    return dataLength + PACKET_OVERHEAD;
+}
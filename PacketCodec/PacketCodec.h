@@ -0,0 +1,56 @@
+
+#ifndef PacketCodec_H
+#define PacketCodec_H
+
+#define PACKET_START            62          // Start of Data ('>')
+#define PACKET_HEADER_SIZE      5           // start, device ID, data type, channel, data length
+#define PACKET_OVERHEAD         6           // header + checksum
+#define PACKET_MAX_SIZE         255
+#define PACKET_MAX_DATA         (PACKET_MAX_SIZE - PACKET_OVERHEAD)
+
+//Data Types
+#define PACKET_TYPE_BATCH       'B'         // data holds sub-commands: data type, channel, data length, data
+#define PACKET_TYPE_REPLY       'A'         // data holds one status byte per command
+#define PACKET_TYPE_NAK         'N'         // data holds the data type of the rejected command
+#define PACKET_TYPE_PUBLISH     'P'         // data holds a 4 byte sequence number, then the status data
+#define PACKET_TYPE_STATUS      'S'         // data holds the state of the channel
+
+//Batch
+#define PACKET_BATCH_HEADER_SIZE    3
+
+//Status
+#define PACKET_STATUS_OK        0
+#define PACKET_STATUS_ERROR     1
+#define PACKET_STATUS_UNKNOWN   2           // no handler registered for the channel
+
+//**************************************************************************
+//PACKET FRAME
+//**************************************************************************
+// Read-only view of one '>' frame. It points into the receive buffer and is
+// only valid as long as that buffer is not reused, so it is cheap to pass by
+// value and needs no global state or locking.
+struct PacketFrame
+{
+    const char* frame;
+    char deviceID;
+    char dataType;
+    char channel;
+    unsigned char dataLength;
+    const char* data;
+
+    int length() const { return dataLength + PACKET_OVERHEAD; }
+};
+
+//Decode & validate start byte, length and checksum - false if the buffer holds no valid frame
+bool packetDecode(const char* buffer, int bufferLength, PacketFrame* packet);
+
+//Get the sub-command at *offset of a batch frame and advance *offset - false at the end or on a malformed sub-command
+bool packetBatchNext(const PacketFrame& batch, int* offset, PacketFrame* command);
+
+//Build a frame into buffer (at least dataLength + PACKET_OVERHEAD bytes) - returns frame length
+int packetEncode(char* buffer, char deviceID, char dataType, char channel, const char* data, int dataLength);
+
+//Sum of the first length bytes
+char packetChecksum(const char* buffer, int length);
+
+#endif
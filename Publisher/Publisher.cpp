@@ -0,0 +1,120 @@
+#include "Publisher.h"
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+Publisher::Publisher()
+{
+    socket = NULL;
+    subscribers = NULL;
+    deviceID = 0;
+    group = false;
+    sequence = 0;
+
+    published = 0;
+    drops = 0;
+}
+
+void Publisher::attach(UDPSocket* socket, Subscribers* subscribers, char deviceID)
+{
+    this->socket = socket;
+    this->subscribers = subscribers;
+    this->deviceID = deviceID;
+}
+
+// Publish to group:port instead of the subscribers - false if the address is not valid
+bool Publisher::multicast(const char* group, int port)
+{
+    if (groupEndpoint.set_address(group, port) != 0) return false;
+
+    this->group = true;
+    return true;
+}
+
+//**************************************************************************
+//PUBLISH
+//**************************************************************************
+// State change - returns the number of subscribers (or groups) it was sent to
+int Publisher::status(char channel, const char* data, int length)
+{
+    int count;
+    int frameLength;
+
+    mutex.lock();
+
+    sequence++;
+
+    if (group)
+    {
+        count = publish(channel, data, length);
+    }
+    else
+    {
+        frameLength = packetEncode(frame, deviceID, 'S', channel, data, length);
+        count = (subscribers != NULL) ? subscribers->send(frame, frameLength) : 0;
+    }
+
+    mutex.unlock();
+    return count;
+}
+
+// Received serial bytes - raw to the subscribers, in 'P' frames to the group, split to fit with a sequence number each
+int Publisher::data(char channel, const char* data, int length)
+{
+    int count = 0;
+    int part;
+
+    mutex.lock();
+
+    if (!group)
+    {
+        sequence++;
+        count = (subscribers != NULL) ? subscribers->send(data, length) : 0;
+    }
+
+    while (group && (length > 0))
+    {
+        part = (length < PACKET_MAX_DATA - PUBLISH_SEQUENCE_SIZE) ? length : PACKET_MAX_DATA - PUBLISH_SEQUENCE_SIZE;
+
+        sequence++;
+        count = publish(channel, data, part);
+        data += part;
+        length -= part;
+    }
+
+    mutex.unlock();
+    return count;
+}
+
+// One 'P' frame with the current sequence to the group - called with the mutex held
+int Publisher::publish(char channel, const char* data, int length)
+{
+    int dataLength = PUBLISH_SEQUENCE_SIZE + length;
+
+    if ((socket == NULL) || (dataLength > PACKET_MAX_DATA)) return 0;
+
+    //Header & sequence
+    frame[0] = PACKET_START;
+    frame[1] = deviceID;
+    frame[2] = PACKET_TYPE_PUBLISH;
+    frame[3] = channel;
+    frame[4] = dataLength;
+    frame[5] = sequence >> 24;
+    frame[6] = sequence >> 16;
+    frame[7] = sequence >> 8;
+    frame[8] = sequence;
+
+    //Data & checksum
+    memcpy(frame + PACKET_HEADER_SIZE + PUBLISH_SEQUENCE_SIZE, data, length);
+    frame[PACKET_HEADER_SIZE + dataLength] = packetChecksum(frame, PACKET_HEADER_SIZE + dataLength);
+
+    if (socket->sendTo(groupEndpoint, frame, dataLength + PACKET_OVERHEAD) < 0)
+    {
+        drops++;
+        return 0;
+    }
+
+    published++;
+    return 1;
+}
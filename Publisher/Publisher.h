@@ -0,0 +1,49 @@
+#ifndef Publisher_H
+#define Publisher_H
+
+#define PUBLISH_SEQUENCE_SIZE   4           // big endian, ahead of the data of a 'P' frame
+
+#include "mbed.h"
+#include "rtos.h"
+#include "EthernetInterface.h"
+#include "PacketCodec.h"
+#include "Subscribers.h"
+
+//**************************************************************************
+//PUBLISHER
+//**************************************************************************
+// State changes over UDP, each with the next sequence number - to every subscriber, or once
+// multicast() is set as one 'P' frame to the group. A gap in the sequence means: read a snapshot.
+class Publisher
+{
+public:
+    Publisher();
+
+    void attach(UDPSocket* socket, Subscribers* subscribers, char deviceID);
+    bool multicast(const char* group, int port);
+    bool multicasting() { return group; }
+
+    int status(char channel, const char* data, int length);
+    int data(char channel, const char* data, int length);
+
+    unsigned long version() { return sequence; }
+
+    unsigned long published;                // datagrams sent to the group
+    unsigned long drops;                    // datagrams the socket refused
+
+private:
+    int publish(char channel, const char* data, int length);
+
+    UDPSocket* socket;
+    Subscribers* subscribers;
+    char deviceID;
+
+    bool group;
+    Endpoint groupEndpoint;
+
+    volatile unsigned long sequence;
+    char frame[PACKET_MAX_SIZE];
+    Mutex mutex;
+};
+
+#endif
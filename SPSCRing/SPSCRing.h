@@ -0,0 +1,106 @@
+#ifndef SPSCRing_H
+#define SPSCRing_H
+
+//**************************************************************************
+//SPSC RING
+//**************************************************************************
+// Lock-free ring of one producer (an interrupt) and one consumer (a thread).
+// The producer stages items ahead of in and publishes them with commit(),
+// the consumer only moves out. SIZE must be a power of two.
+template<class T, int SIZE>
+class SPSCRing
+{
+public:
+    SPSCRing() { in = 0; out = 0; staged = 0; }
+
+    //Consumer
+    int available() const { return (in - out) & (SIZE - 1); }
+    bool empty() const { return in == out; }
+    T front() const { return buffer[out]; }
+    void pop() { out = (out + 1) & (SIZE - 1); }
+    int read(T* data, int length);
+    int read_to(int end, T* data, int length);
+    void clear() { out = in; }
+
+    //Producer
+    int room() const { return (out - staged - 1) & (SIZE - 1); }
+    bool stage(T value);
+    T staged_back(int back) const { return buffer[(staged - back) & (SIZE - 1)]; }
+    void commit() { in = staged; }
+    void rollback() { staged = in; }
+    bool put(T value) { if (!stage(value)) return false; commit(); return true; }
+    int head() const { return in; }
+
+private:
+    // Compile time check - the index wraps with a mask
+    typedef char SizeIsPowerOfTwo[((SIZE & (SIZE - 1)) == 0) ? 1 : -1];
+
+    volatile T buffer[SIZE];
+    volatile int in;                            // written by the producer only
+    volatile int out;                           // written by the consumer only
+    int staged;                                 // producer only
+};
+
+
+//**************************************************************************
+//CONSUMER
+//**************************************************************************
+// Copy up to length items - returns the number copied, their slots are released
+template<class T, int SIZE>
+int SPSCRing<T, SIZE>::read(T* data, int length)
+{
+    int position = out;
+    int count = (in - position) & (SIZE - 1);
+
+    if (count > length) count = length;
+
+    for (int i = 0; i < count; i++)
+    {
+        data[i] = buffer[position];
+        position = (position + 1) & (SIZE - 1);
+    }
+
+    // Release the slots only after the items are copied
+    out = position;
+
+    return count;
+}
+
+// Copy up to length of the items before end (a head() of the producer) - everything up to end is released
+template<class T, int SIZE>
+int SPSCRing<T, SIZE>::read_to(int end, T* data, int length)
+{
+    int position = out;
+    int count = (end - position) & (SIZE - 1);
+
+    if (count > length) count = length;
+
+    for (int i = 0; i < count; i++)
+    {
+        data[i] = buffer[position];
+        position = (position + 1) & (SIZE - 1);
+    }
+
+    out = end;
+
+    return count;
+}
+
+//**************************************************************************
+//PRODUCER
+//**************************************************************************
+// Write one item past the published ones - false if the ring is full
+template<class T, int SIZE>
+bool SPSCRing<T, SIZE>::stage(T value)
+{
+    int next = (staged + 1) & (SIZE - 1);
+
+    if (next == out) return false;
+
+    buffer[staged] = value;
+    staged = next;
+
+    return true;
+}
+
+#endif
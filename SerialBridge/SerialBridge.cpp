@@ -0,0 +1,88 @@
+#include "SerialBridge.h"
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+SerialBridge::SerialBridge()
+{
+    window_ms = 0;
+    size = BRIDGE_DATAGRAM_SIZE;
+
+    bytes = 0;
+    datagrams = 0;
+    drops = 0;
+
+    publisher = NULL;
+    channel = 0;
+    length = 0;
+    first_us = 0;
+}
+
+//**************************************************************************
+//ADD
+//**************************************************************************
+// Append one frame - sends the datagram once it is full or the window is 0
+void SerialBridge::add(const char* data, int length)
+{
+    int limit = ((size > 0) && (size < BRIDGE_DATAGRAM_SIZE)) ? size : BRIDGE_DATAGRAM_SIZE;
+    int count;
+
+    while (length > 0)
+    {
+        //No room for the whole frame - send what is waiting first
+        if ((this->length > 0) && (this->length + length > limit)) flush();
+
+        if (this->length == 0) first_us = us_ticker_read();
+
+        //Frames longer than a datagram are split
+        count = (length < limit - this->length) ? length : limit - this->length;
+        memcpy(buffer + this->length, data, count);
+        this->length += count;
+        data += count;
+        length -= count;
+
+        if ((window_ms == 0) || (this->length == limit)) flush();
+    }
+}
+
+//**************************************************************************
+//POLL
+//**************************************************************************
+// Send the datagram once its window has closed - returns the ms until it closes, at most idle_ms
+unsigned int SerialBridge::poll(unsigned int idle_ms)
+{
+    int remaining;
+
+    if (length == 0) return idle_ms;
+
+    remaining = (int)(first_us + window_ms * 1000 - us_ticker_read());
+    if (remaining <= 0)
+    {
+        flush();
+        return idle_ms;
+    }
+
+    remaining = (remaining + 999) / 1000;
+    return ((unsigned int)remaining < idle_ms) ? remaining : idle_ms;
+}
+
+//**************************************************************************
+//FLUSH
+//**************************************************************************
+void SerialBridge::flush()
+{
+    if (length == 0) return;
+
+    if ((publisher != NULL) && (publisher->data(channel, buffer, length) > 0))
+    {
+        bytes += length;
+        datagrams++;
+    }
+    else
+    {
+        drops += length;
+    }
+
+    length = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef SerialBridge_H
+#define SerialBridge_H
+
+#define BRIDGE_DATAGRAM_SIZE    256         // largest datagram sent
+
+#include "mbed.h"
+#include "us_ticker_api.h"
+#include "Publisher.h"
+
+//**************************************************************************
+//SERIAL BRIDGE
+//**************************************************************************
+// Serial to UDP bridge of one port - frames are coalesced into one datagram per window_ms,
+// sent through the Publisher.
+class SerialBridge
+{
+public:
+    SerialBridge();
+
+    void attach(Publisher* publisher, char channel) { this->publisher = publisher; this->channel = channel; }
+
+    void add(const char* data, int length);
+    unsigned int poll(unsigned int idle_ms);
+    void flush();
+
+    unsigned int window_ms;
+    int size;
+
+    unsigned long bytes;                    // bytes sent
+    unsigned long datagrams;
+    unsigned long drops;                    // bytes nobody got
+
+private:
+    Publisher* publisher;
+    char channel;                           // of the port, in 'P' frames
+
+    char buffer[BRIDGE_DATAGRAM_SIZE];
+    int length;
+    unsigned int first_us;                  // first byte of the datagram
+};
+
+#endif
@@ -0,0 +1,658 @@
+
+#ifndef SerialUART_H
+#define SerialUART_H
+
+#define UART_FIFO_SIZE      16          // TX FIFO bytes loaded per THRE interrupt
+#define UART_LSR_OE         0x02        // receiver overrun
+#define UART_LSR_THRE       0x20        // TX holding register / FIFO empty
+#define UART_LSR_TEMT       0x40        // transmitter (FIFO & shift register) empty
+
+#define SERIAL_FRAME_PACKET         0   // '>' frames, length & checksum checked
+#define SERIAL_FRAME_TERMINATOR     1   // up to & including 1 or 2 terminator bytes
+#define SERIAL_FRAME_IDLE           2   // up to an idle gap on the line
+#define SERIAL_FRAME_FIXED          3   // a fixed number of bytes, from a start byte if one is set
+#define SERIAL_FRAME_PASSTHROUGH    4   // whatever has arrived
+#define SERIAL_FRAME_QUEUE          16  // frame ends waiting for the reader - power of two
+
+#define SERIAL_FRAME_HUNT           0x1000000                                   // fixed frames: start byte set
+#define SERIAL_FRAME_START(c)       (SERIAL_FRAME_HUNT | ((unsigned char)(c) << 16))
+
+#include "mbed.h"
+#include "rtos.h"
+#include "us_ticker_api.h"
+#include "PacketCodec.h"
+#include "SPSCRing.h"
+
+//**************************************************************************
+//UART PORTS
+//**************************************************************************
+// Register block of each LPC1768 UART, bound at compile time.
+// UART1 has its own register layout (modem & RS485 control).
+template<int N> struct SerialUARTPort;
+
+template<> struct SerialUARTPort<0>
+{
+    typedef LPC_UART_TypeDef Registers;
+    static Registers* registers() { return LPC_UART0; }
+};
+
+template<> struct SerialUARTPort<1>
+{
+    typedef LPC_UART1_TypeDef Registers;
+    static Registers* registers() { return LPC_UART1; }
+};
+
+template<> struct SerialUARTPort<2>
+{
+    typedef LPC_UART_TypeDef Registers;
+    static Registers* registers() { return LPC_UART2; }
+};
+
+template<> struct SerialUARTPort<3>
+{
+    typedef LPC_UART_TypeDef Registers;
+    static Registers* registers() { return LPC_UART3; }
+};
+
+//**************************************************************************
+//SERIAL UART
+//**************************************************************************
+// Interrupt driven UART0..3 - the RX interrupt frames the bytes and publishes whole frames,
+// TX streams from a ring, with an optional RS485 driver enable pin. Ring sizes are powers of two, LINE_SIZE is the longest frame.
+template<int N, int TX_SIZE = 256, int RX_SIZE = 256, int LINE_SIZE = 255>
+class SerialUART : public Serial
+{
+public:
+    SerialUART(PinName tx, PinName rx);
+
+    void baud(int baudrate);
+    int baud_rate() { return rate; }
+    void driver_enable(DigitalOut* pin, unsigned int guard_us);
+    void framing(int mode, unsigned int parameter);
+    int framing_mode() { return rx_mode; }
+    unsigned int framing_parameter() { return rx_parameter; }
+    void notify(osThreadId thread, int32_t signal);
+
+    bool send(const char* data, int length) { return send(data, length, NULL, 0); }
+    bool send(const char* header, int headerLength, const char* payload, int payloadLength);
+    int write(const char* data, size_t length);
+    int write_nonblocking(const char* data, size_t length);
+    bool tx_busy() { return tx_active; }
+    int read_frame(char* buffer, int length, unsigned int timeout_ms);
+
+    int rx_available() { return rx_ring.available(); }
+    int read(char* buffer, int length);
+    int read(char* buffer, int length, unsigned int timeout_ms);
+
+    volatile unsigned long rx_bytes;
+    volatile unsigned long rx_overruns;         // bytes or frames dropped on a full ring or frame queue
+    volatile unsigned long rx_hw_overruns;      // bytes lost in the UART FIFO (LSR OE)
+
+    volatile unsigned long rx_frames;           // frames published
+    volatile unsigned long rx_resyncs;          // packet & fixed mode - garbage skipped or bad length
+    volatile unsigned long rx_bad_checksums;    // packet mode
+
+    volatile unsigned long tx_bytes;
+    volatile unsigned long tx_drops;            // frames refused on a full ring
+    volatile unsigned long tx_bursts;           // driver enable periods
+    volatile unsigned long tx_busy_us;          // total bus occupancy
+    volatile unsigned long tx_last_us;          // occupancy of the last burst
+    volatile unsigned long tx_max_us;
+
+private:
+    typedef SerialUARTPort<N> Port;
+
+    int tx_put(const char* data, int length, const char* more, int moreLength, bool whole);
+
+    void tx_start();
+    void tx_begin();
+    void tx_fill();
+    void tx_drain();
+
+    bool rx_ready(bool frame) { return frame ? !rx_ends.empty() : !rx_ring.empty(); }
+    void rx_wait(unsigned int timeout_ms, bool frame);
+    void rx_wake();
+    bool rx_frame_byte(char c);
+    bool rx_packet_byte(char c);
+    bool rx_frame_publish();
+    void rx_frame_drop();
+    void rx_idle();
+
+    void Tx_interrupt();
+    void Rx_interrupt();
+
+    int rx_mode;                                // SERIAL_FRAME_xxx
+    unsigned int rx_parameter;                  // terminator bytes, idle gap in us or frame length
+
+    SPSCRing<char, TX_SIZE> tx_ring;            // producers serialised by a critical section
+    SPSCRing<char, RX_SIZE> rx_ring;            // frames are staged until complete
+
+    volatile bool tx_active;                    // ring draining - driver enabled
+    volatile bool tx_guarding;                  // waiting for the turnaround guard
+    volatile bool tx_waiting;                   // write() sleeps on a full ring
+    unsigned int tx_start_us;
+
+    DigitalOut* de;
+    unsigned int guard_us;
+    int rate;
+    unsigned int char_us;                       // one character on the line
+    volatile unsigned int rx_last_us;
+    Timeout tx_timeout;
+    volatile bool rx_waiting;
+    osThreadId rx_thread;
+    int32_t rx_signal;
+
+    SPSCRing<int, SERIAL_FRAME_QUEUE> rx_ends;  // rx_ring head after each published frame
+    Timeout rx_timeout;
+
+    int rx_frame_pos;
+    int rx_frame_length;
+    unsigned char rx_frame_sum;
+    bool rx_hunting;
+
+    Semaphore rx_sem;
+    Semaphore tx_sem;
+};
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::SerialUART(PinName tx, PinName rx) : Serial(tx,rx), rx_sem(0), tx_sem(0)
+{
+    rx_mode = SERIAL_FRAME_PACKET;
+    rx_parameter = 0;
+
+    tx_active = false;
+    tx_guarding = false;
+    tx_waiting = false;
+    tx_start_us = 0;
+
+    de = NULL;
+    guard_us = 0;
+    rate = 9600;
+    char_us = 10 * 1000000 / 9600 + 1;
+    rx_last_us = 0;
+
+    tx_bytes = 0;
+    tx_drops = 0;
+    tx_bursts = 0;
+    tx_busy_us = 0;
+    tx_last_us = 0;
+    tx_max_us = 0;
+    rx_waiting = false;
+    rx_thread = NULL;
+    rx_signal = 0;
+
+    rx_frame_pos = 0;
+    rx_frame_length = 0;
+    rx_frame_sum = 0;
+    rx_hunting = false;
+
+    rx_bytes = 0;
+    rx_overruns = 0;
+    rx_hw_overruns = 0;
+    rx_frames = 0;
+    rx_resyncs = 0;
+    rx_bad_checksums = 0;
+
+    // attach the interrupts
+    Serial::attach(this, &SerialUART::Rx_interrupt, Serial::RxIrq);
+    Serial::attach(this, &SerialUART::Tx_interrupt, Serial::TxIrq);
+}
+
+//**************************************************************************
+//SETTINGS
+//**************************************************************************
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::baud(int baudrate)
+{
+    Serial::baud(baudrate);
+    rate = baudrate;
+
+    // start + 8 data + parity/stop
+    char_us = 10 * 1000000 / baudrate + 1;
+}
+
+// RS485 - pin driven high while transmitting, UART1's own direction control needs DE on RTS1/DTR1 and the board has it on p12
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::driver_enable(DigitalOut* pin, unsigned int guard_us)
+{
+    de = pin;
+    this->guard_us = guard_us;
+    de->write(0);
+}
+
+// Receive framing - parameter: terminator bytes (0x0D or 0x0D0A), idle gap in us or frame length (| SERIAL_FRAME_START(c))
+// Called from the reading thread - unread bytes & the frame in progress are dropped, frame ends of one mode mean nothing in another
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::framing(int mode, unsigned int parameter)
+{
+    rx_timeout.detach();
+
+    __disable_irq();
+
+        rx_mode = mode;
+        rx_parameter = parameter;
+        rx_ring.clear();
+        rx_ends.clear();
+        rx_frame_drop();
+
+    __enable_irq();
+}
+
+// Signal a thread whenever a frame is published - from the RX interrupt
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::notify(osThreadId thread, int32_t signal)
+{
+    rx_signal = signal;
+    rx_thread = thread;
+}
+
+//**************************************************************************
+//SEND
+//**************************************************************************
+// Queue header & payload back to back without blocking - false if the ring has no room for all of it
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+bool SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::send(const char* header, int headerLength, const char* payload, int payloadLength)
+{
+    if ((headerLength + payloadLength > 0) && (tx_put(header, headerLength, payload, payloadLength, true) == 0))
+    {
+        tx_drops++;
+        return false;
+    }
+
+    return true;
+}
+
+// Queue as much as fits - returns the number of bytes queued
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+int SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::write_nonblocking(const char* data, size_t length)
+{
+    return tx_put(data, length, NULL, 0, false);
+}
+
+// Queue everything - waits only while the ring is full
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+int SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::write(const char* data, size_t length)
+{
+    int queued = 0;
+
+    while (queued < (int)length)
+    {
+        queued += tx_put(data + queued, length - queued, NULL, 0, false);
+        if (queued == (int)length) break;
+
+        // Sleep until the TX interrupt frees room - the flag is set before the ring is checked again, so no wakeup is missed
+        tx_waiting = true;
+        if (tx_ring.room() == 0) tx_sem.wait(10);
+        tx_waiting = false;
+    }
+
+    return queued;
+}
+
+// Copy data, then more, into the ring under one critical section & start the transmitter - whole: all or nothing
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+int SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::tx_put(const char* data, int length, const char* more, int moreLength, bool whole)
+{
+    int count;
+
+    // Start Critical Section - the TX interrupt, the turnaround Timeout & other sending threads also move the ring
+    __disable_irq();
+
+        count = tx_ring.room();
+        if (count > length + moreLength) count = length + moreLength;
+        if (whole && (count < length + moreLength)) count = 0;
+
+        //Set Tx Buffer
+        for (int i = 0; i < count; i++)
+        {
+            tx_ring.stage((i < length) ? data[i] : more[i - length]);
+        }
+        tx_ring.commit();
+
+        //Start draining, or refill a FIFO that ran empty while the driver is still on
+        if (count > 0)
+        {
+            if (!tx_active) tx_start();
+            else if (!tx_guarding && (Port::registers()->LSR & UART_LSR_THRE)) tx_fill();
+        }
+
+    // End Critical Section
+    __enable_irq();
+
+    return count;
+}
+
+// Begin a burst - after the turnaround guard
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::tx_start()
+{
+    unsigned int elapsed = us_ticker_read() - rx_last_us;
+
+    tx_active = true;
+    tx_guarding = (de != NULL) && (elapsed < guard_us);
+
+    if (tx_guarding) tx_timeout.attach_us(this, &SerialUART::tx_begin, guard_us - elapsed);
+    else tx_begin();
+}
+
+// Interupt Routine (or called with interrupts disabled) - driver on & first FIFO load
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::tx_begin()
+{
+    tx_guarding = false;
+    if (de != NULL) de->write(1);
+    tx_start_us = us_ticker_read();
+
+    tx_fill();
+}
+
+// Load the TX FIFO from the ring - only when the FIFO is empty (THRE)
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::tx_fill()
+{
+    for (int i = 0; (i < UART_FIFO_SIZE) && !tx_ring.empty(); i++)
+    {
+        Port::registers()->THR = tx_ring.front();
+        tx_ring.pop();
+        tx_bytes++;
+    }
+}
+
+// Interupt Routine to write out data to serial port
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::Tx_interrupt()
+{
+    if (!tx_active || tx_guarding) return;
+
+    if (!tx_ring.empty())
+    {
+        tx_fill();
+
+        // Room for a waiting writer
+        if (tx_waiting)
+        {
+            tx_waiting = false;
+            tx_sem.release();
+        }
+        return;
+    }
+
+    //Ring empty - the last byte is still in the shift register
+    if (de != NULL) tx_timeout.attach_us(this, &SerialUART::tx_drain, char_us);
+    else tx_active = false;
+}
+
+// Interupt Routine - drop the driver once the transmitter is empty
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::tx_drain()
+{
+    unsigned int busy;
+
+    //More data queued meanwhile - keep the driver on
+    if (!tx_ring.empty())
+    {
+        if (Port::registers()->LSR & UART_LSR_THRE) tx_fill();
+        return;
+    }
+
+    //Still shifting
+    if ((Port::registers()->LSR & UART_LSR_TEMT) == 0)
+    {
+        tx_timeout.attach_us(this, &SerialUART::tx_drain, (char_us / 4) + 1);
+        return;
+    }
+
+    de->write(0);
+    tx_active = false;
+
+    //Bus occupancy
+    busy = us_ticker_read() - tx_start_us;
+    tx_bursts++;
+    tx_busy_us += busy;
+    tx_last_us = busy;
+    if (busy > tx_max_us) tx_max_us = busy;
+}
+
+//**************************************************************************
+//READ
+//**************************************************************************
+// Copy the next complete frame - waits up to timeout_ms, returns its length or 0, bytes beyond length are dropped
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+int SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::read_frame(char* buffer, int length, unsigned int timeout_ms)
+{
+    int count;
+
+    //Passthrough - no frame ends, everything received so far
+    if (rx_mode == SERIAL_FRAME_PASSTHROUGH)
+    {
+        if (!rx_ready(false)) rx_wait(timeout_ms, false);
+        return read(buffer, length);
+    }
+
+    if (!rx_ready(true)) rx_wait(timeout_ms, true);
+    if (!rx_ready(true)) return 0;
+
+    count = rx_ring.read_to(rx_ends.front(), buffer, length);
+    rx_ends.pop();
+
+    return count;
+}
+
+// Copy up to length received bytes - returns the number copied, 0 if none are waiting
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+int SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::read(char* buffer, int length)
+{
+    return rx_ring.read(buffer, length);
+}
+
+// Same as read(), waiting up to timeout_ms for the first byte
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+int SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::read(char* buffer, int length, unsigned int timeout_ms)
+{
+    if (!rx_ready(false)) rx_wait(timeout_ms, false);
+
+    return read(buffer, length);
+}
+
+// Sleep until the RX interrupt publishes bytes or a frame - the flag is set before the ring is checked again, so no wakeup is missed
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::rx_wait(unsigned int timeout_ms, bool frame)
+{
+    rx_waiting = true;
+    if (!rx_ready(frame)) rx_sem.wait(timeout_ms);
+    rx_waiting = false;
+}
+
+// Interupt Routine - wake the reader if it sleeps & signal the serving thread
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::rx_wake()
+{
+    if (rx_waiting)
+    {
+        rx_waiting = false;
+        rx_sem.release();
+    }
+
+    if (rx_thread != NULL) osSignalSet(rx_thread, rx_signal);
+}
+
+// Interupt Routine to read in data from serial port
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::Rx_interrupt()
+{
+    bool framed = false;
+
+    // Receiver overrun - the UART FIFO was not emptied in time
+    if (Port::registers()->LSR & UART_LSR_OE) rx_hw_overruns++;
+    rx_last_us = us_ticker_read();
+
+    // The ring head moves when a frame completes
+    while (readable())
+    {
+        rx_bytes++;
+        if (rx_frame_byte(Port::registers()->RBR)) framed = true;
+    }
+
+    // Passthrough - publish what arrived, idle gap - publish once the line stays quiet
+    if ((rx_mode == SERIAL_FRAME_PASSTHROUGH) && (rx_frame_pos > 0) && rx_frame_publish()) framed = true;
+    if ((rx_mode == SERIAL_FRAME_IDLE) && (rx_frame_pos > 0)) rx_timeout.attach_us(this, &SerialUART::rx_idle, rx_parameter);
+
+    if (framed) rx_wake();
+}
+
+// Interupt Routine - the line stayed idle for the gap
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::rx_idle()
+{
+    if ((rx_mode == SERIAL_FRAME_IDLE) && (rx_frame_pos > 0) && rx_frame_publish()) rx_wake();
+}
+
+// Framing - called from the RX interrupt, true when a frame was published
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+bool SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::rx_frame_byte(char c)
+{
+    if (rx_mode == SERIAL_FRAME_PACKET) return rx_packet_byte(c);
+
+    //Fixed frames with a start byte - hunt for it, one resync per run of garbage
+    if ((rx_mode == SERIAL_FRAME_FIXED) && (rx_frame_pos == 0) && (rx_parameter & SERIAL_FRAME_HUNT))
+    {
+        if ((unsigned char)c != ((rx_parameter >> 16) & 0xFF))
+        {
+            if (!rx_hunting) rx_resyncs++;
+            rx_hunting = true;
+            return false;
+        }
+
+        rx_hunting = false;
+    }
+
+    //Ring full - drop the frame
+    if (!rx_ring.stage(c))
+    {
+        rx_overruns++;
+        rx_frame_drop();
+        return false;
+    }
+
+    rx_frame_pos++;
+
+    switch (rx_mode)
+    {
+        //Last terminator byte, preceded by the first one if there are two
+        case SERIAL_FRAME_TERMINATOR:
+            if ((unsigned char)c != (rx_parameter & 0xFF)) break;
+            if ((rx_parameter <= 0xFF) || ((rx_frame_pos > 1) && ((unsigned char)rx_ring.staged_back(2) == ((rx_parameter >> 8) & 0xFF))))
+            {
+                return rx_frame_publish();
+            }
+            break;
+
+        case SERIAL_FRAME_FIXED:
+            if (rx_frame_pos >= (int)(rx_parameter & 0xFFFF)) return rx_frame_publish();
+            break;
+    }
+
+    //Longer than a line - cut it
+    if (rx_frame_pos == LINE_SIZE) return rx_frame_publish();
+
+    return false;
+}
+
+// Packet mode framing - true when a valid frame was published
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+bool SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::rx_packet_byte(char c)
+{
+    //Hunting for the start byte - one resync per run of garbage
+    if (rx_frame_pos == 0)
+    {
+        if (c != PACKET_START)
+        {
+            if (!rx_hunting) rx_resyncs++;
+            rx_hunting = true;
+            return false;
+        }
+
+        rx_hunting = false;
+        rx_frame_sum = 0;
+    }
+
+    //Ring full - drop the frame
+    if (!rx_ring.stage(c))
+    {
+        rx_overruns++;
+        rx_frame_drop();
+        return false;
+    }
+
+    rx_frame_pos++;
+
+    //Data length from the header
+    if (rx_frame_pos == PACKET_HEADER_SIZE)
+    {
+        rx_frame_length = (unsigned char)c + PACKET_OVERHEAD;
+        if (rx_frame_length > LINE_SIZE)
+        {
+            rx_resyncs++;
+            rx_frame_drop();
+            return false;
+        }
+    }
+
+    //Checksum - sum of all preceding bytes
+    if ((rx_frame_pos > PACKET_HEADER_SIZE) && (rx_frame_pos == rx_frame_length))
+    {
+        if ((unsigned char)c != rx_frame_sum)
+        {
+            rx_bad_checksums++;
+            rx_frame_drop();
+            return false;
+        }
+
+        return rx_frame_publish();
+    }
+
+    rx_frame_sum += c;
+    return false;
+}
+
+// Publish the frame being received & queue its end - a full frame queue drops it
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+bool SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::rx_frame_publish()
+{
+    //Passthrough - the reader takes bytes, not frames
+    if (rx_mode == SERIAL_FRAME_PASSTHROUGH)
+    {
+        rx_ring.commit();
+        rx_frame_pos = 0;
+        return true;
+    }
+
+    if (rx_ends.room() == 0)
+    {
+        rx_overruns++;
+        rx_frame_drop();
+        return false;
+    }
+
+    // Bytes first, then the end - the reader never sees an end past the ring head
+    rx_ring.commit();
+    rx_ends.put(rx_ring.head());
+
+    rx_frame_pos = 0;
+    rx_frames++;
+    return true;
+}
+
+// Roll back the frame being received & hunt for the next start byte
+template<int N, int TX_SIZE, int RX_SIZE, int LINE_SIZE>
+void SerialUART<N, TX_SIZE, RX_SIZE, LINE_SIZE>::rx_frame_drop()
+{
+    rx_ring.rollback();
+    rx_frame_pos = 0;
+}
+
+#endif
@@ -0,0 +1,195 @@
+#include "Subscribers.h"
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+Subscribers::Subscribers()
+{
+    socket = NULL;
+    ttl_s = SUBSCRIBER_TTL_S;
+    refused = 0;
+    evicted = 0;
+
+    for (int i = 0; i < SUBSCRIBER_COUNT; i++)
+    {
+        subscriber[i].used = false;
+        subscriber[i].permanent = false;
+        subscriber[i].expires = 0;
+        subscriber[i].sent = 0;
+        subscriber[i].drops = 0;
+    }
+}
+
+//**************************************************************************
+//ADD
+//**************************************************************************
+// Subscribe address:port - ttl_s 0 = permanent
+bool Subscribers::add(const char* address, int port, unsigned int ttl_s)
+{
+    Endpoint endpoint;
+
+    if (endpoint.set_address(address, port) != 0) return false;
+
+    return add(endpoint, ttl_s);
+}
+
+// Subscribe or refresh an endpoint - a permanent subscriber stays permanent
+bool Subscribers::add(Endpoint& endpoint, unsigned int ttl_s)
+{
+    int index;
+
+    mutex.lock();
+
+    index = find(endpoint);
+    if (index < 0)
+    {
+        index = slot();
+        if (index < 0)
+        {
+            refused++;
+            mutex.unlock();
+            return false;
+        }
+
+        subscriber[index].used = true;
+        subscriber[index].permanent = false;
+        subscriber[index].endpoint = endpoint;
+        subscriber[index].sent = 0;
+        subscriber[index].drops = 0;
+    }
+
+    if (ttl_s == SUBSCRIBER_PERMANENT) subscriber[index].permanent = true;
+    subscriber[index].expires = time(NULL) + ttl_s;
+
+    mutex.unlock();
+    return true;
+}
+
+// Source of an incoming command
+bool Subscribers::learn(Endpoint& endpoint)
+{
+    if (ttl_s == 0) return false;
+
+    return add(endpoint, ttl_s);
+}
+
+bool Subscribers::remove(Endpoint& endpoint)
+{
+    int index;
+
+    mutex.lock();
+
+    index = find(endpoint);
+    if (index >= 0) subscriber[index].used = false;
+
+    mutex.unlock();
+    return index >= 0;
+}
+
+//**************************************************************************
+//SEND
+//**************************************************************************
+// Send one datagram to every live subscriber - returns the number it was sent to
+int Subscribers::send(const char* data, int length)
+{
+    time_t now = time(NULL);
+    int count = 0;
+
+    if (socket == NULL) return 0;
+
+    mutex.lock();
+
+    for (int i = 0; i < SUBSCRIBER_COUNT; i++)
+    {
+        if (!subscriber[i].used || expired(i, now)) continue;
+
+        if (socket->sendTo(subscriber[i].endpoint, (char*)data, length) < 0)
+        {
+            subscriber[i].drops++;
+            continue;
+        }
+
+        subscriber[i].sent++;
+        count++;
+    }
+
+    mutex.unlock();
+    return count;
+}
+
+//**************************************************************************
+//STATUS
+//**************************************************************************
+// Copy of slot index - false if the slot is empty or expired
+bool Subscribers::get(int index, Subscriber* subscriber)
+{
+    bool live;
+
+    if ((index < 0) || (index >= SUBSCRIBER_COUNT)) return false;
+
+    mutex.lock();
+
+    live = this->subscriber[index].used && !expired(index, time(NULL));
+    if (live) *subscriber = this->subscriber[index];
+
+    mutex.unlock();
+    return live;
+}
+
+int Subscribers::count()
+{
+    time_t now = time(NULL);
+    int count = 0;
+
+    mutex.lock();
+
+    for (int i = 0; i < SUBSCRIBER_COUNT; i++)
+    {
+        if (subscriber[i].used && !expired(i, now)) count++;
+    }
+
+    mutex.unlock();
+    return count;
+}
+
+//**************************************************************************
+//TABLE
+//**************************************************************************
+// Called with the mutex held
+int Subscribers::find(Endpoint& endpoint)
+{
+    for (int i = 0; i < SUBSCRIBER_COUNT; i++)
+    {
+        if (subscriber[i].used && (subscriber[i].endpoint.get_port() == endpoint.get_port()) &&
+            (strcmp(subscriber[i].endpoint.get_address(), endpoint.get_address()) == 0))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// Free or expired slot, else the learned one closest to expiry - -1 if all are permanent, called with the mutex held
+int Subscribers::slot()
+{
+    time_t now = time(NULL);
+    int oldest = -1;
+
+    for (int i = 0; i < SUBSCRIBER_COUNT; i++)
+    {
+        if (!subscriber[i].used || expired(i, now)) return i;
+
+        if (!subscriber[i].permanent && ((oldest < 0) || (subscriber[i].expires < subscriber[oldest].expires))) oldest = i;
+    }
+
+    if (oldest >= 0) evicted++;
+
+    return oldest;
+}
+
+bool Subscribers::expired(int index, time_t now)
+{
+    return !subscriber[index].permanent && (now >= subscriber[index].expires);
+}
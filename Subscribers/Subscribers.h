@@ -0,0 +1,58 @@
+#ifndef Subscribers_H
+#define Subscribers_H
+
+#define SUBSCRIBER_COUNT        8
+#define SUBSCRIBER_TTL_S        300         // lifetime of a learned subscriber
+#define SUBSCRIBER_PERMANENT    0           // ttl - never expires
+
+#include "mbed.h"
+#include "rtos.h"
+#include "EthernetInterface.h"
+
+//**************************************************************************
+//SUBSCRIBERS
+//**************************************************************************
+// UDP endpoints that get feedback & bridged serial data - from Config.txt (permanent) or
+// learned from incoming commands with a TTL. Shared by all threads, guarded by a mutex.
+class Subscribers
+{
+public:
+    struct Subscriber
+    {
+        bool used;
+        bool permanent;
+        time_t expires;
+        Endpoint endpoint;                  // resolved once
+        unsigned long sent;                 // datagrams
+        unsigned long drops;                // datagrams the socket refused
+    };
+
+    Subscribers();
+
+    void attach(UDPSocket* socket) { this->socket = socket; }
+
+    bool add(const char* address, int port, unsigned int ttl_s);
+    bool add(Endpoint& endpoint, unsigned int ttl_s);
+    bool learn(Endpoint& endpoint);
+    bool remove(Endpoint& endpoint);
+
+    int send(const char* data, int length);
+
+    bool get(int index, Subscriber* subscriber);
+    int count();
+
+    unsigned int ttl_s;                     // learned subscribers, 0 = do not learn
+    unsigned long refused;                  // table full of permanent subscribers
+    unsigned long evicted;                  // learned subscribers replaced on a full table
+
+private:
+    int find(Endpoint& endpoint);
+    int slot();
+    bool expired(int index, time_t now);
+
+    UDPSocket* socket;
+    Subscriber subscriber[SUBSCRIBER_COUNT];
+    Mutex mutex;
+};
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef TCPBridge_H
+#define TCPBridge_H
+
+#define TCP_BRIDGE_CHUNK        256         // bytes moved per direction & poll
+#define TCP_BRIDGE_POLL_MS      1           // poll period while a client is connected
+#define TCP_BRIDGE_ACCEPT_MS    100         // poll period while listening
+
+#include "mbed.h"
+#include "EthernetInterface.h"
+#include "SerialUART.h"
+
+// Client socket - a readable or writable socket that fails was closed or reset
+class TCPBridgeConnection : public TCPSocketConnection
+{
+public:
+    bool readable() { TimeInterval timeout(0); return wait_readable(timeout) == 0; }
+    bool writable() { TimeInterval timeout(0); return wait_writable(timeout) == 0; }
+};
+
+//**************************************************************************
+//TCP BRIDGE
+//**************************************************************************
+// Transparent TCP to serial bridge of one port, one client at a time - non-blocking, so one
+// thread can poll several. The port is in passthrough while a client is connected.
+template<class SERIAL>
+class TCPBridge
+{
+public:
+    TCPBridge(SERIAL& serial);
+
+    bool listen(int port);
+    bool listening() { return open; }
+    bool connected() { return active; }
+
+    unsigned int poll(unsigned int idle_ms);
+
+    unsigned long connections;
+    unsigned long rx_bytes;                 // socket to serial, this connection
+    unsigned long tx_bytes;                 // serial to socket, this connection
+    int duration_ms() { return timer.read_ms(); }
+
+private:
+    void accept();
+    void close();
+
+    SERIAL& serial;
+    TCPSocketServer server;
+    TCPBridgeConnection client;
+    bool open;
+    bool active;
+    Timer timer;
+
+    int mode;                               // framing restored on close
+    unsigned int parameter;
+
+    char in[TCP_BRIDGE_CHUNK];              // from the socket, waiting for TX ring room
+    int inLength;
+    int inOffset;
+    char out[TCP_BRIDGE_CHUNK];             // from the UART, waiting for the socket
+    int outLength;
+    int outOffset;
+};
+
+
+//**************************************************************************
+//CONSTRUCTOR
+//**************************************************************************
+template<class SERIAL>
+TCPBridge<SERIAL>::TCPBridge(SERIAL& serial) : serial(serial)
+{
+    connections = 0;
+    rx_bytes = 0;
+    tx_bytes = 0;
+
+    open = false;
+    active = false;
+    mode = SERIAL_FRAME_PACKET;
+    parameter = 0;
+
+    inLength = 0;
+    inOffset = 0;
+    outLength = 0;
+    outOffset = 0;
+}
+
+//**************************************************************************
+//LISTEN
+//**************************************************************************
+template<class SERIAL>
+bool TCPBridge<SERIAL>::listen(int port)
+{
+    if ((server.bind(port) < 0) || (server.listen(1) < 0)) return false;
+
+    server.set_blocking(false, 0);
+    open = true;
+
+    return true;
+}
+
+//**************************************************************************
+//POLL
+//**************************************************************************
+// Accept a client, move one chunk each way - returns the ms until the next poll, at most idle_ms
+template<class SERIAL>
+unsigned int TCPBridge<SERIAL>::poll(unsigned int idle_ms)
+{
+    int count;
+    unsigned int wait_ms;
+    bool gone = false;
+
+    if (!open) return idle_ms;
+
+    if (!active) accept();
+    if (!active)
+    {
+        wait_ms = TCP_BRIDGE_ACCEPT_MS;
+        return (wait_ms < idle_ms) ? wait_ms : idle_ms;
+    }
+
+    //Socket to serial - receive only once the last chunk is queued, a readable socket with nothing to read was closed or reset
+    if ((inOffset == inLength) && client.readable())
+    {
+        count = client.receive(in, TCP_BRIDGE_CHUNK);
+        inOffset = 0;
+        inLength = (count > 0) ? count : 0;
+        gone = (count <= 0);
+    }
+    if (inOffset < inLength)
+    {
+        count = serial.write_nonblocking(in + inOffset, inLength - inOffset);
+        inOffset += count;
+        rx_bytes += count;
+    }
+
+    //Serial to socket - read only once the last chunk is sent
+    if (outOffset == outLength)
+    {
+        outLength = serial.read_frame(out, TCP_BRIDGE_CHUNK, 0);
+        outOffset = 0;
+    }
+    if (!gone && (outOffset < outLength) && client.writable())
+    {
+        count = client.send(out + outOffset, outLength - outOffset);
+        if (count > 0)
+        {
+            outOffset += count;
+            tx_bytes += count;
+        }
+        gone = (count <= 0);
+    }
+
+    //Client gone - closed, reset or aborted
+    if (gone || !client.is_connected()) close();
+
+    wait_ms = TCP_BRIDGE_POLL_MS;
+    return (wait_ms < idle_ms) ? wait_ms : idle_ms;
+}
+
+template<class SERIAL>
+void TCPBridge<SERIAL>::accept()
+{
+    if (server.accept(client) != 0) return;
+
+    client.set_blocking(false, 0);
+    active = true;
+    connections++;
+    rx_bytes = 0;
+    tx_bytes = 0;
+    timer.reset();
+    timer.start();
+
+    inLength = inOffset = 0;
+    outLength = outOffset = 0;
+
+    //Raw bytes while the client is connected
+    mode = serial.framing_mode();
+    parameter = serial.framing_parameter();
+    serial.framing(SERIAL_FRAME_PASSTHROUGH, 0);
+}
+
+template<class SERIAL>
+void TCPBridge<SERIAL>::close()
+{
+    client.close();
+    active = false;
+    timer.stop();
+
+    serial.framing(mode, parameter);
+}
+
+#endif
@@ -13,9 +13,17 @@
 #include "mbed.h"
 #include "rtos.h"
 #include "EthernetInterface.h"
-#include "SerialUART1.h"
-#include "SerialUART3.h"
-#include "SerialUART2.h"
+#include "SerialUART.h"
+#include "PacketCodec.h"
+#include "IRCode.h"
+#include "IRTransmitter.h"
+#include "IRScheduler.h"
+#include "GPIOInput.h"
+#include "GPIOGesture.h"
+#include "Subscribers.h"
+#include "Publisher.h"
+#include "SerialBridge.h"
+#include "TCPBridge.h"
 #include <string>
 #include <iostream>
 #include <stdlib.h>
@@ -28,23 +36,35 @@ using namespace std;
 #define UDP_PORT    51984
 
 //RS485
-#define RS485_Read   0
-#define RS485_Write   1
+#define RS485_GUARD_US  8000            //bus turnaround - peers keep their driver on up to 8 ms after sending
+
+//LOG LEVEL
+#define LOG_NONE    0
+#define LOG_ERROR   1
+#define LOG_INFO    2
+#define LOG_DEBUG   3
+
+//SYSTEM CHANNELS
+#define SYSTEM_LOG_LEVEL    1
+#define SYSTEM_IR_CACHE     2
+#define SYSTEM_IR_STATUS    3
+#define SYSTEM_RS232_STATUS 4
+#define SYSTEM_TCP_STATUS   5
+#define SYSTEM_SUBSCRIBE    6
+#define SYSTEM_SNAPSHOT     7
+#define SYSTEM_RS485_STATUS 8
+
+//PACKET SOURCE
+#define SOURCE_UDP      0
+#define SOURCE_RS485    1
+
+//RS232 THREAD
+#define RS232_SIGNAL    0x01            //a frame is complete on either port
 
 //**************************************************************************
 //GLOBAL VARIABLES
 //**************************************************************************
 
-//GLOBAL
-char feedbackString[255];
-
-//PACKET DATA
-int Packet_DeviceID;
-char Packet_DataType;
-int Packet_Channel;
-int Packet_Data_Length;
-char PacketData[255];
-
 //SYSTEM CONFIG
 int deviceID = 1;
 string IPAddress = "192.168.1.100";
@@ -52,6 +72,17 @@ string SubnetMask = "255.255.255.0";
 string Gateway = "192.168.1.1";
 int RS232Port1BaudRate;
 int RS232Port2BaudRate;
+int logLevel = LOG_INFO;
+
+//RS232 FRAMING - SERIAL_FRAME_xxx & parameter per port
+int RS232Framing[2] = { SERIAL_FRAME_FIXED, SERIAL_FRAME_PACKET };
+unsigned int RS232FramingParameter[2] = { 5 | SERIAL_FRAME_START(PACKET_START), 0 };
+
+//RS232 BRIDGE - frames to UDP, coalesced per window
+SerialBridge RS232_bridge[2];
+
+//RS232 TCP BRIDGE - listening port per RS232 port, 0 = off
+int RS232TcpPort[2] = { 0, 0 };
 
 //LOCAL FILE SYSTEM
 LocalFileSystem local("local"); 
@@ -59,7 +90,9 @@ FILE *file;
 char line[128];
 
 //IR
-char IRCode[1024];
+char IRLine[1024];
+unsigned short IRTiming[IR_PORT_COUNT][2 * IR_MAX_PAIRS];     //codes not in the cache, one table per port
+IRCodeCache IR_cache;
 
 //ETHERNET
 EthernetInterface ethernet;
@@ -67,6 +100,10 @@ EthernetInterface ethernet;
 //UDP
 UDPSocket UDP_server;
 Endpoint UDP_endpoint;
+Subscribers UDP_subscribers;                    //feedback & bridged serial data go to all of them
+Publisher UDP_publisher;                        //... or to the multicast group, with a sequence number
+string MulticastGroup;                          //empty = no multicast
+int MulticastPort = UDP_PORT;
 char UDP_buffer[255];
 
 //RELAY
@@ -74,14 +111,7 @@ bool statusRelay1 = false;
 bool statusRelay2 = false;
 bool statusRelay3 = false;
 
-//GPIO
-int inputLowcounter[12];
-int inputHighcounter[12];
-bool inputFlag[12];
-
 //Mutexs
-Mutex PacketParser_Mutex;
-Mutex PacketHandler_Mutex;
 Mutex WriteRelay_Mutex;
 Mutex WriteRS_Mutex;
 Mutex WriteIR_Mutex;
@@ -94,27 +124,25 @@ Mutex WriteIR_Mutex;
 Serial USB(USBTX, USBRX);                      
 
 //RS485
-SerialUART1 RS485(p13,p14);                    
+SerialUART<1> RS485(p13,p14);                    
 DigitalOut RS485_Mode(p12);
+char RS485_buffer[255];                         //one frame, only the RS485 thread reads it
 
 //RS232
-SerialUART3 RS232_1(p9,p10);                    
-SerialUART2 RS232_2(p28,p27);                   
+SerialUART<3> RS232_1(p9,p10);                   
+SerialUART<2> RS232_2(p28,p27);                   
+TCPBridge< SerialUART<3> > RS232_1_tcp(RS232_1);
+TCPBridge< SerialUART<2> > RS232_2_tcp(RS232_2);
 
 //RELAY
 DigitalOut Relay1(p5);                        
 DigitalOut Relay2(p6);                         
 DigitalOut Relay3(p7);                         
 
-//GPIO
-DigitalInOut GPIO1(p15);                        
-DigitalInOut GPIO2(p16);                        
-DigitalInOut GPIO3(p17);                       
-DigitalInOut GPIO4(p18);                      
-DigitalInOut GPIO5(p19);                        
-DigitalInOut GPIO6(p20);                       
-DigitalInOut GPIO7(p11);                         
-DigitalInOut GPIO8(p8);                      
+//GPIO - InterruptIn works on ports 0 & 2 only: GPIO5 (p19) & GPIO6 (p20) are on port 1 and sampled by the tick
+const PinName GPIOPins[GPIO_COUNT] = { p15, p16, p17, p18, p19, p20, p11, p8 };
+GPIOInput GPIO_input(GPIOPins, 0xCF);
+GPIOGesture GPIO_gesture;
 
 //IR
 PwmOut IR1(p26);
@@ -123,6 +151,21 @@ PwmOut IR3(p24);
 PwmOut IR4(p23);
 PwmOut IR5(p22);
 PwmOut IR6(p21);
+IRTransmitter IR1_tx(IR1);
+IRTransmitter IR2_tx(IR2);
+IRTransmitter IR3_tx(IR3);
+IRTransmitter IR4_tx(IR4);
+IRTransmitter IR5_tx(IR5);
+IRTransmitter IR6_tx(IR6);
+IRTransmitter* IRTransmitters[IR_PORT_COUNT] = { &IR1_tx, &IR2_tx, &IR3_tx, &IR4_tx, &IR5_tx, &IR6_tx };
+IRScheduler IR_scheduler(IRTransmitters);
+
+//IR repeat count per port - used when the IR frame carries no repeat count
+const char IRRepeat[IR_PORT_COUNT] = { 1, 1, 3, 5, 1, 1 };
+
+//IR frame repeat byte: 1..254 times, IR_REPEAT_HOLD until released, IR_REPEAT_RELEASE ends a hold
+#define IR_REPEAT_RELEASE   0
+char IRHeld[IR_PORT_COUNT];                 //IR channel held on each port
 
 //LED
 DigitalOut led1(LED1);
@@ -140,35 +183,88 @@ void mainStart();
 //LOCAL FILE SYSTEM 
 void read_ConfigFile();
 string parse_Line(const char* ptrLine);
+string parse_Key(const char* ptrLine);
+bool parse_Framing(const string& value, int* mode, unsigned int* parameter);
+
+//LOG
+void logPacket(const char* title, const char* buffer, int length);
 
 
 //PACKET HANDLER FUNCTIONS
-void packetParser(char* packet);
-void packetHandler(char Packet_DataType, int Packet_Channel, int Packet_Data_Length, char* PacketData);
-void writeRS485(char* value);
-void writeIR(char channel, char btnID);
+void packetHandler(PacketFrame packet, char source);
+char packetDispatch(PacketFrame packet, char source);
+void packetReply(char source, char* frame, int length);
+void initChannelTable();
+
+//CHANNEL HANDLERS
+char systemHandler(PacketFrame packet, char channel, char source);
+char gpioHandler(PacketFrame packet, char channel, char source);
+char relayHandler(PacketFrame packet, char channel, char source);
+char rs232Handler(PacketFrame packet, char channel, char source);
+char irHandler(PacketFrame packet, char channel, char source);
+char rs485Handler(PacketFrame packet, char channel, char source);
 
 //RS232
-void writeRS232(char channel, char* data, int length);
+bool writeRS232(char channel, const char* data, int length);
+bool configRS232(char channel, const char* data, int length);
+void rs232StatusFeedback(char source);
+void rs485StatusFeedback(char source);
+template<class SERIAL> void serialCounters(SERIAL& serial, unsigned long* counter);
+void tcpStatusFeedback(char source);
+
+//SUBSCRIBERS
+char subscribe(PacketFrame packet, char source);
+void subscriberStatusFeedback(char source);
+
+//SNAPSHOT
+void snapshotFeedback(char source);
+void snapshotSerial(char* data, int baudrate, int framing, bool client, bool transmitting);
 
 //RELAY
-void writeRelay(char channel, char value);
+bool writeRelay(char channel, char value);
 void relayStatusFeedback(char channel, char value);
 
 //IR
-void writeIR(char IRPort, char IRChannel);
-void send_IR_Code(char IRPort, char* IRCode);
+bool writeIR(char IRPort, char IRChannel, int repeat);
+void send_IR_Code(char IRPort, const IRCode& code, int repeat);
+void load_IR_Codes();
+void wait_IR_Idle();
+void irStatusFeedback(char source);
+void irCacheStatusFeedback(char source);
 
 //GPIO
-void GPIO1_LowEvent();
-void GPIO2_LowEvent();
-void GPIO3_LowEvent();
-void GPIO4_LowEvent();
-void GPIO5_LowEvent();
-void GPIO6_LowEvent();
-void GPIO7_LowEvent();
-void GPIO8_LowEvent();
-void gpioStatusFeedback(char channel, char value);
+void gpioGesture(int pin, int gesture, unsigned int time_us);
+void gpioStatusFeedback(char channel, char gesture, unsigned int time_us);
+
+
+//**************************************************************************
+//CHANNEL TABLE
+//**************************************************************************
+//Channel handler - channel is relative to the range base
+typedef char (*ChannelHandler)(PacketFrame packet, char channel, char source);
+
+struct ChannelRange
+{
+    unsigned char first;
+    unsigned char last;
+    unsigned char base;
+    ChannelHandler handler;
+};
+
+//Register a subsystem by adding its channel range here
+const ChannelRange channelRanges[] =
+{
+    //first  last  base  handler
+    {  1,     9,    0,   systemHandler },          //SYSTEM
+    { 11,    19,   10,   gpioHandler   },          //GPIO
+    { 21,    29,   20,   relayHandler  },          //RELAY
+    { 31,    39,   30,   rs232Handler  },          //RS232
+    { 41,    49,   40,   irHandler     },          //IR
+    { 50,    50,   50,   rs485Handler  },          //RS485
+};
+
+//Channel byte -> channelRanges index + 1, 0 = unknown channel
+unsigned char channelTable[256];
 
 
 //**************************************************************************
@@ -178,51 +274,29 @@ void gpioStatusFeedback(char channel, char value);
 //UDP_thread
 void UDP_thread(void const *args) 
 {
+    int UDP_PacketLength;
+    PacketFrame packet;
         
     while (true) 
     {    
-        //Wait for packet receive       
-        printf("Waiting for UDP packet...\n"); Thread::wait(100);         
-        UDP_server.receiveFrom(UDP_endpoint, UDP_buffer, sizeof(UDP_buffer));       
-        
+        //Wait for packet receive - blocks on the socket only, so queued datagrams are drained back-to-back
+        UDP_PacketLength = UDP_server.receiveFrom(UDP_endpoint, UDP_buffer, sizeof(UDP_buffer));       
+        if(UDP_PacketLength <= 0) continue;
  
-        //Print Data & CheckSum
-        char UDP_PacketLength = UDP_buffer[4] + 6;
-        char Checksum = 0;
-        printf("UDP Data:"); 
-        for(int i = 0 ; i < UDP_PacketLength; i++)
-        {
-            printf("%c", UDP_buffer[i]); 
-            if (i != UDP_PacketLength - 1 ) Checksum = Checksum + UDP_buffer[i];
-        }
+        //Print Data
+        logPacket("UDP Data: ", UDP_buffer, UDP_PacketLength);
         
-        
-        //Packet Parser
-        if(Checksum == UDP_buffer[UDP_PacketLength - 1])
+        //Packet Decode & Handler - packet points into UDP_buffer, no copy
+        if(packetDecode(UDP_buffer, UDP_PacketLength, &packet) && (packet.deviceID == deviceID))
         { 
-            PacketParser_Mutex.lock();                       
-            packetParser(UDP_buffer); 
-            PacketParser_Mutex.unlock();   
-        }
-        
-        //Packet Handler
-        if(Packet_DeviceID == deviceID)
-        {   
-            PacketHandler_Mutex.lock();   
-            packetHandler(Packet_DataType, Packet_Channel, Packet_Data_Length, PacketData); 
-            PacketHandler_Mutex.unlock();             
+            //Learn the sender - it gets the feedback from now on
+            UDP_subscribers.learn(UDP_endpoint);
+            
+            packetHandler(packet, SOURCE_UDP);
         }
         
-                
-        //Clear UDP_buffer
-        memset(UDP_buffer, 0x00, 255);
-        
         //Debug Led
         led2 = !led2;
-        
-        //Thread wait in ms   
-        Thread::wait(100);      
-        
     }
 }
 
@@ -230,221 +304,69 @@ void UDP_thread(void const *args)
 //RS485_thread
 void RS485_thread(const void *args)
 {
+    PacketFrame packet;
+    int length;
+    
     while (true) 
     {    
-        //RS485 read
-        RS485_Mode = RS485_Read; 
-        
         //Wait for packet receive       
-        printf("Waiting for RS485 data...\n"); 
+        if(logLevel >= LOG_DEBUG) printf("Waiting for RS485 data...\n"); 
           
-        //Read a line from the large rx buffer from rx interrupt routine
-        RS485.read_line();
+        //Read the next frame - the rx interrupt routine has already checked it, one wakeup per frame
+        length = RS485.read_frame(RS485_buffer, sizeof(RS485_buffer), osWaitForever);
+        if(length == 0) continue;
         
-        //Print Data & CheckSum
-        char Checksum = 0;
-        printf("RS485 Data: "); 
-        for(int i = 0 ; i < RS485.packetLength; i++)
-        {
-            printf("%c", RS485.rx_data_bytes[i]); 
-            if (i != RS485.packetLength - 1 ) Checksum = Checksum + RS485.rx_data_bytes[i];
-        }
-        printf("\n");
+        //Print Data
+        logPacket("RS485 Data: ", RS485_buffer, length);
                 
-        //CheckSum
-        if(Checksum == RS485.rx_data_bytes[RS485.packetLength - 1])
+        //Packet Decode & Handler - packet points into RS485_buffer, no copy, the bus is shared so only frames for this unit
+        if(packetDecode(RS485_buffer, length, &packet) && (packet.deviceID == deviceID))
         {
-            //Packet Parser 
-            PacketParser_Mutex.lock();  
-            packetParser(RS485.rx_data_bytes); 
-            PacketParser_Mutex.unlock();  
-                    
-            //Packet Handler
-            PacketHandler_Mutex.lock();  
-            packetHandler(Packet_DataType, Packet_Channel, Packet_Data_Length, PacketData);  
-            PacketHandler_Mutex.unlock();     
+            packetHandler(packet, SOURCE_RS485);
         }
         
-        //Clear RS485 Buffer
-        memset(RS485.rx_data_bytes, 0x00, 255);   
-        
         //Debug Led
         led3 = !led3;
-        
-        //Thread wait in ms   
-        Thread::wait(100);      
     }    
 }
 
-//RS232_1_thread
-void RS232_1_thread(const void *args)
+//RS232_thread - serves both ports, frames go to the bridges as soon as the rx interrupt routine completes them
+//A port with a TCP client streams raw bytes to & from it instead
+void RS232_thread(const void *args)
 {
+    char frame[256];
+    int length;
+    unsigned int wait_ms;
+    
+    RS232_1.notify(osThreadGetId(), RS232_SIGNAL);
+    RS232_2.notify(osThreadGetId(), RS232_SIGNAL);
+    
     while (true) 
     {
-                        
-        //Read a line from the large rx buffer from rx interrupt routine
-        RS232_1.read_line();
+        //TCP clients - accept & stream
+        wait_ms = RS232_1_tcp.poll(osWaitForever);
+        wait_ms = RS232_2_tcp.poll(wait_ms);
         
-        //Print Data 
-        printf("RS232_1 Data: "); 
-        for(int i = 0 ; i < RS232_1.packetLength; i++)
+        //Drain both ports - a frame completed meanwhile sets the signal again
+        while (!RS232_1_tcp.connected() && ((length = RS232_1.read_frame(frame, sizeof(frame), 0)) > 0))
         {
-            printf("%c", RS232_1.rx_data_bytes[i]); 
+            logPacket("RS232_1 Data: ", frame, length);
+            RS232_bridge[0].add(frame, length);
         }
-        printf("\n"); 
-        
-        //Send Received Data to TouchPanel
-        UDP_endpoint.set_address("192.168.1.51", UDP_PORT); 
-        UDP_server.sendTo(UDP_endpoint, RS232_1.rx_data_bytes, RS232_1.packetLength);
-             
-        //Clear RS232_1 Buffer
-        memset(RS232_1.rx_data_bytes, 0x00, 255);  
-        
-        //Debug Print
-        printf("RS232_1_thread\n");
-        
-        //Thread wait in ms              
-        Thread::wait(1000);  
-           
-    }    
-}
-
-//RS232_2_thread
-void RS232_2_thread(const void *args)
-{
-    while (true) 
-    {                     
-        //Read a line from the large rx buffer from rx interrupt routine
-        RS232_2.read_line();
-        
-        //Print Data 
-        printf("RS232_2 Data: "); 
-        for(int i = 0 ; i < RS232_2.packetLength; i++)
+        while (!RS232_2_tcp.connected() && ((length = RS232_2.read_frame(frame, sizeof(frame), 0)) > 0))
         {
-            printf("%c", RS232_2.rx_data_bytes[i]); 
+            logPacket("RS232_2 Data: ", frame, length);
+            RS232_bridge[1].add(frame, length);
         }
-        printf("\n");
         
-        //Send Received Data to TouchPanel
-        UDP_endpoint.set_address("192.168.1.51", UDP_PORT); 
-        UDP_server.sendTo(UDP_endpoint, RS232_2.rx_data_bytes, RS232_2.packetLength);
-               
-        //Clear RS232_2 Buffer
-        memset(RS232_2.rx_data_bytes, 0x00, 255); 
-        
-        //Debug Print
-        printf("RS232_2_thread\n");
-        
-        //Thread wait in ms              
-        Thread::wait(1000);                 
+        //Send closed windows, then sleep until a frame is complete, the next window closes or the TCP bridges poll
+        wait_ms = RS232_bridge[0].poll(wait_ms);
+        wait_ms = RS232_bridge[1].poll(wait_ms);
+        Thread::signal_wait(RS232_SIGNAL, wait_ms);
     }    
 }
 
 
-//GPIO_thread
-void GPIO_thread(void const *args)
-{
-    while (true) 
-    {
-        //Thread Debug Led
-        led4= !led4;  
-        
-        //Check GPIO
-        if( GPIO1 == 0) inputLowcounter[0]++; if( GPIO1 == 1) inputHighcounter[0]++;   
-        if( GPIO2 == 0) inputLowcounter[1]++; if( GPIO2 == 1) inputHighcounter[1]++;
-        if( GPIO3 == 0) inputLowcounter[2]++; if( GPIO3 == 1) inputHighcounter[2]++;
-        if( GPIO4 == 0) inputLowcounter[3]++; if( GPIO4 == 1) inputHighcounter[3]++;
-        if( GPIO5 == 0) inputLowcounter[4]++; if( GPIO5 == 1) inputHighcounter[4]++;
-        if( GPIO6 == 0) inputLowcounter[5]++; if( GPIO6 == 1) inputHighcounter[5]++;
-        if( GPIO7 == 0) inputLowcounter[6]++; if( GPIO7 == 1) inputHighcounter[6]++;
-        if( GPIO8 == 0) inputLowcounter[7]++; if( GPIO8 == 1) inputHighcounter[7]++;
-
-        //GPIO State Result
-        for(int i = 0; i < 8; i++)
-        {
-            //GPIO LOW State
-            if (inputLowcounter[i] > 45) 
-            {                
-                //Print status
-                printf("GPIO%d LOW \n", (i+1));
-                
-                //GPIO Events
-                if(inputFlag[i] == false)
-                {
-                    switch (i)
-                    {   
-                        //GPIO1
-                        case 0:
-                            GPIO1_LowEvent();
-                            break;
-                            
-                        //GPIO2
-                        case 1:
-                            GPIO2_LowEvent();
-                            break;
-                            
-                        //GPIO3
-                        case 2:
-                            GPIO3_LowEvent();
-                            break;
-                            
-                        //GPIO4
-                        case 3:
-                            GPIO4_LowEvent();
-                            break;
-                            
-                        //GPIO5
-                        case 4:
-                            GPIO5_LowEvent();
-                            break;
-                            
-                        //GPIO6
-                        case 5:
-                            GPIO6_LowEvent();
-                            break;
-                            
-                        //GPIO7
-                        case 6:
-                            GPIO7_LowEvent();
-                            break;
-                            
-                        //GPIO8
-                        case 7:
-                            GPIO8_LowEvent();
-                            break;
-                    }
-                }
-                
-                //Set input flag
-                inputFlag[i] = true;
-                
-                //Clear counters
-                inputHighcounter[i] = 0;
-                inputLowcounter[i] = 0;
-                               
-            }
-    
-            if (inputHighcounter[i] > 5) 
-            {                
-                //Reset input flag
-                inputFlag[i] = false;
-                
-                //Clear counters
-                inputHighcounter[i] = 0;
-                inputLowcounter[i] = 0;
-            }
-         }
-              
-        //Debug Led
-        led4 = !led4; 
-        
-        //Thread wait in ms              
-        Thread::wait(5);  
-              
-    }
-}
-
-
 //**************************************************************************
 //MAIN
 //**************************************************************************
@@ -454,19 +376,18 @@ int main()
     //Initialize the System
     mainStart();
     
-    //Start Threads (CURRENTLY, IT IS NOT POSSIBLE TO WORK WITH MORE THAN 4 THREADS) ASK TO SUPPORT!
+    //Start Threads (CURRENTLY, IT IS NOT POSSIBLE TO WORK WITH MORE THAN 4 THREADS) - one thread serves both RS232 ports
     Thread threadUDP(UDP_thread);
-    //Thread threadGPIO(GPIO_thread);
     Thread threadRS485(RS485_thread);
-    //Thread threadRS232_1(RS232_1_thread);
-    //Thread threadRS232_2(RS232_2_thread);
+    Thread threadRS232(RS232_thread);
 
     
-    //Infinite Loop 
+    //Infinite Loop - GPIO events & long press deadlines, heartbeat while idle
+    GPIOEvent event;
     while (1) 
     {
-        led1 = !led1;              
-        Thread::wait(1000);
+        if (GPIO_input.get(&event, GPIO_gesture.poll(1000))) GPIO_gesture.update(event);
+        else led1 = !led1;
     }
 }
 
@@ -479,33 +400,49 @@ void mainStart()
     //SYSTEM CONFIGURATION
     read_ConfigFile();
     
+    //PACKET DISPATCH
+    initChannelTable();
+    
     //ETHERNET Use Static
     ethernet.init(IPAddress.c_str(), SubnetMask.c_str(), Gateway.c_str());     
     ethernet.connect();
     
     //UDP Init    
     UDP_server.bind(UDP_PORT);
+    
+    //Subscribers - the TouchPanel unless Config.txt names others
+    UDP_subscribers.attach(&UDP_server);
+    if(UDP_subscribers.count() == 0) UDP_subscribers.add("192.168.1.51", UDP_PORT, SUBSCRIBER_PERMANENT);
+    
+    //Publisher - state changes to the subscribers, or once to the multicast group
+    UDP_publisher.attach(&UDP_server, &UDP_subscribers, deviceID);
+    if((MulticastGroup.length() > 0) && !UDP_publisher.multicast(MulticastGroup.c_str(), MulticastPort)) printf("Error: MulticastGroup %s\n", MulticastGroup.c_str());
 
     
-    //RS485 Init
+    //RS485 Init - DE on p12
     RS485.baud(9600);
+    RS485.driver_enable(&RS485_Mode, RS485_GUARD_US);
        
     //RS232_1 Init
     RS232_1.baud(9600);
+    RS232_1.framing(RS232Framing[0], RS232FramingParameter[0]);
     
     //RS232_2 Init
     RS232_2.baud(9600);
     RS232_2.format(8, Serial::Odd, 1);
+    RS232_2.framing(RS232Framing[1], RS232FramingParameter[1]);
+    
+    //RS232 Bridges - published on the RS232 channels
+    RS232_bridge[0].attach(&UDP_publisher, 31);
+    RS232_bridge[1].attach(&UDP_publisher, 32);
+    
+    //RS232 TCP Bridges
+    if((RS232TcpPort[0] > 0) && !RS232_1_tcp.listen(RS232TcpPort[0])) printf("Error: RS232_1 TCP port %d\n", RS232TcpPort[0]);
+    if((RS232TcpPort[1] > 0) && !RS232_2_tcp.listen(RS232TcpPort[1])) printf("Error: RS232_2 TCP port %d\n", RS232TcpPort[1]);
     
     //GPIO
-    GPIO1.mode(PullUp);
-    GPIO2.mode(PullUp);
-    GPIO3.mode(PullUp);
-    GPIO4.mode(PullUp);
-    GPIO5.mode(PullUp);
-    GPIO6.mode(PullUp);
-    GPIO7.mode(PullUp);
-    GPIO8.mode(PullUp);
+    GPIO_gesture.attach(gpioGesture);
+    GPIO_input.start();
     
     //IR Init
     IR1 = 0.0f;
@@ -514,6 +451,7 @@ void mainStart()
     IR4 = 0.0f;
     IR5 = 0.0f;
     IR6 = 0.0f;
+    load_IR_Codes();
      
     //System Initialize OK
     printf("System Initialize OK...\n");
@@ -525,113 +463,442 @@ void mainStart()
 // PACKET HANDLER
 //**************************************************************************
 
-//Packet Handler
-void packetParser(char* packet)
+//Packet Event Handler
+void packetHandler(PacketFrame packet, char source)
 {
+    PacketFrame command;
+    char status[PACKET_MAX_DATA];
+    char reply[PACKET_MAX_SIZE];
+    int replyLength;
+    int offset = 0;
+    int count = 0;
+    
+    //Replies & feedback of other units are never answered - on the shared bus they would echo forever
+    if((packet.dataType == PACKET_TYPE_NAK) || (packet.dataType == PACKET_TYPE_REPLY) ||
+       (packet.dataType == PACKET_TYPE_STATUS) || (packet.dataType == PACKET_TYPE_PUBLISH)) return;
+    
+    //Single Command - unknown channels are answered with a NAK
+    if(packet.dataType != PACKET_TYPE_BATCH)
+    {
+        if(packetDispatch(packet, source) == PACKET_STATUS_UNKNOWN)
+        {
+            replyLength = packetEncode(reply, deviceID, PACKET_TYPE_NAK, packet.channel, &packet.dataType, 1);
+            packetReply(source, reply, replyLength);
+        }
+        return;
+    }
+    
+    //Batch - dispatch sub-commands in order
+    while(packetBatchNext(packet, &offset, &command))
+    {
+        if(command.dataType == PACKET_TYPE_BATCH) status[count] = PACKET_STATUS_ERROR;
+        else status[count] = packetDispatch(command, source);
+        count++;
+    }
+    
+    //Malformed tail
+    if(offset != packet.dataLength) status[count++] = PACKET_STATUS_ERROR;
+    
+    //Aggregated status reply
+    replyLength = packetEncode(reply, deviceID, PACKET_TYPE_REPLY, packet.channel, status, count);
+    packetReply(source, reply, replyLength);
+}
 
-    //Device ID
-    Packet_DeviceID = packet[1];
 
-    //Data Type
-    Packet_DataType = packet[2];
-   
-    //Channel
-    Packet_Channel = packet[3];
+//Packet Dispatch - O(1) lookup of the channel handler, returns PACKET_STATUS_UNKNOWN for unregistered channels
+char packetDispatch(PacketFrame packet, char source)
+{        
+    unsigned char index = channelTable[(unsigned char)packet.channel];
     
-    //DataLength
-    Packet_Data_Length = packet[4];
+    if(index == 0) return PACKET_STATUS_UNKNOWN;
     
-    //Data
-    //printf("PacketData:"); 
-    for(int i = 0 ; i < Packet_Data_Length; i++)
-    {   
-        PacketData[i] = packet[5 + i]; 
-        //printf("%c", PacketData[i]); 
-    }    
+    const ChannelRange& range = channelRanges[index - 1];
+    return range.handler(packet, packet.channel - range.base, source);
 }
 
 
-//Packet Event Handler
-void packetHandler(char Packet_DataType, int Packet_Channel, int Packet_Data_Length, char* PacketData)
-{        
-    //SystemData   
-    if( (0 < Packet_Channel) && (Packet_Channel < 10) )
+//Channel Table - fill the channel byte lookup from channelRanges
+void initChannelTable()
+{
+    memset(channelTable, 0x00, sizeof(channelTable));
+    
+    for(unsigned int i = 0; i < sizeof(channelRanges) / sizeof(channelRanges[0]); i++)
     {
-        
-    }                 
+        for(int channel = channelRanges[i].first; channel <= channelRanges[i].last; channel++)
+        {
+            channelTable[channel] = i + 1;
+        }
+    }
+}
+
+
+//System Handler
+char systemHandler(PacketFrame packet, char channel, char source)
+{
+    //Set Log Level
+    if((packet.dataType == 'W') && (channel == SYSTEM_LOG_LEVEL) && (packet.dataLength > 0))
+    {
+        logLevel = packet.data[0];
+        return PACKET_STATUS_OK;
+    }
     
-    //GPIO Data
-    else if ( (10 < Packet_Channel) && (Packet_Channel < 20) ) 
+    //Reload IR Cache
+    if((packet.dataType == 'W') && (channel == SYSTEM_IR_CACHE))
     {
-        
-    }       
+        WriteIR_Mutex.lock();
+        load_IR_Codes();
+        WriteIR_Mutex.unlock();
+        return PACKET_STATUS_OK;
+    }
     
-    //RELAY Data
-    else if ( (20 < Packet_Channel) && (Packet_Channel < 30) ) 
+    //Read IR Cache Statistics
+    if((packet.dataType == 'R') && (channel == SYSTEM_IR_CACHE))
     {
-        //Write Command
-        if(Packet_DataType == 'W')
-        {
-            Packet_Channel = Packet_Channel - 20;
-            writeRelay(Packet_Channel, PacketData[0]);
-        }
-    }         
+        irCacheStatusFeedback(source);
+        return PACKET_STATUS_OK;
+    }
     
-     //RS232 Data
-    else if ( (30 < Packet_Channel) && (Packet_Channel < 40) )                                    
+    //Read IR Transmitter Status
+    if((packet.dataType == 'R') && (channel == SYSTEM_IR_STATUS))
     {
-        //Write Command
-        if(Packet_DataType == 'W')
-        { 
-            Packet_Channel = Packet_Channel - 30;
-            writeRS232(Packet_Channel, PacketData, Packet_Data_Length);
+        irStatusFeedback(source);
+        return PACKET_STATUS_OK;
+    }
+    
+    //Read RS232 Bridge Status
+    if((packet.dataType == 'R') && (channel == SYSTEM_RS232_STATUS))
+    {
+        rs232StatusFeedback(source);
+        return PACKET_STATUS_OK;
+    }
+    
+    //Read RS485 Status
+    if((packet.dataType == 'R') && (channel == SYSTEM_RS485_STATUS))
+    {
+        rs485StatusFeedback(source);
+        return PACKET_STATUS_OK;
+    }
+    
+    //Read RS232 TCP Bridge Status
+    if((packet.dataType == 'R') && (channel == SYSTEM_TCP_STATUS))
+    {
+        tcpStatusFeedback(source);
+        return PACKET_STATUS_OK;
+    }
+    
+    //Subscribe / Unsubscribe the sender
+    if((packet.dataType == 'W') && (channel == SYSTEM_SUBSCRIBE))
+    {
+        return subscribe(packet, source);
+    }
+    
+    //Read Subscribers
+    if((packet.dataType == 'R') && (channel == SYSTEM_SUBSCRIBE))
+    {
+        subscriberStatusFeedback(source);
+        return PACKET_STATUS_OK;
+    }
+    
+    //Read Snapshot - the whole state in one frame
+    if((packet.dataType == 'R') && (channel == SYSTEM_SNAPSHOT))
+    {
+        snapshotFeedback(source);
+        return PACKET_STATUS_OK;
+    }
+    
+    return PACKET_STATUS_ERROR;
+}
+
+
+//GPIO Handler
+char gpioHandler(PacketFrame packet, char channel, char source)
+{
+    return PACKET_STATUS_ERROR;
+}
+
+
+//Relay Handler
+char relayHandler(PacketFrame packet, char channel, char source)
+{
+    char status = PACKET_STATUS_ERROR;
+    
+    //Write Command
+    if((packet.dataType == 'W') && (packet.dataLength > 0))
+    {
+        WriteRelay_Mutex.lock();
+        if(writeRelay(channel, packet.data[0])) status = PACKET_STATUS_OK;
+        WriteRelay_Mutex.unlock();
+    }
+    
+    return status;
+}
+
+
+//RS232 Handler
+char rs232Handler(PacketFrame packet, char channel, char source)
+{
+    char status = PACKET_STATUS_ERROR;
+    
+    //Write Command
+    if(packet.dataType == 'W')
+    {
+        WriteRS_Mutex.lock();
+        if(writeRS232(channel, packet.data, packet.dataLength)) status = PACKET_STATUS_OK;
+        WriteRS_Mutex.unlock();
+    }
+    
+    //Config Command - baud rate, optionally data bits, parity & stop bits
+    if(packet.dataType == 'C')
+    {
+        if(configRS232(channel, packet.data, packet.dataLength)) status = PACKET_STATUS_OK;
+    }
+    
+    return status;
+}
+
+
+//IR Handler
+char irHandler(PacketFrame packet, char channel, char source)
+{
+    char status = PACKET_STATUS_ERROR;
+    char IRChannel;
+    int repeat;
+    
+    //The range reserves 41-49, only 41-46 have a port
+    if((channel < 1) || (channel > IR_PORT_COUNT)) return PACKET_STATUS_ERROR;
+    
+    if(packet.dataLength > 0)
+    {
+        IRChannel = packet.data[0];
+        repeat = (packet.dataLength > 1) ? (unsigned char)packet.data[1] : IRRepeat[channel - 1];
+        
+        WriteIR_Mutex.lock();
+        
+        //Release - the held code ends after its current frame
+        if(repeat == IR_REPEAT_RELEASE)
+        {
+            IR_scheduler.release(channel);
+            status = PACKET_STATUS_OK;
+        }
+        
+        //Hold of the code already on the air - keep it going
+        else if((repeat == IR_REPEAT_HOLD) && IR_scheduler.holding(channel) && (IRHeld[channel - 1] == IRChannel))
+        {
+            IR_scheduler.hold(channel);
+            status = PACKET_STATUS_OK;
         }
+        
+        //New code - ends any hold on the port
+        else
+        {
+            IR_scheduler.release(channel);
+            if(writeIR(channel, IRChannel, repeat)) status = PACKET_STATUS_OK;
+            IRHeld[channel - 1] = IRChannel;
+        }
+        
+        WriteIR_Mutex.unlock();
     }
     
-     //IR Data
-    if ( (40 < Packet_Channel) && (Packet_Channel < 50) )  
+    return status;
+}
+
+
+//RS485 Handler
+char rs485Handler(PacketFrame packet, char channel, char source)
+{
+    //Queue the data - the driver is switched by the UART interrupts
+    if(!RS485.send(packet.data, packet.dataLength)) return PACKET_STATUS_ERROR;
+    
+    return PACKET_STATUS_OK;
+}
+
+
+//Packet Reply - send a frame back on the link the request came from
+void packetReply(char source, char* frame, int length)
+{
+    switch(source)
     {
-        Packet_Channel = Packet_Channel - 40; 
-                
-        writeIR(Packet_Channel, PacketData[0]);             
-    }  
-       
-    //RS485 Data
-    else if ( Packet_Channel == 50 )                                                                
-    {      
-        wait_ms(8);
-        RS485_Mode = RS485_Write;                                      
-        for(int i = 0 ; i < Packet_Data_Length; i++)
-            {
-                RS485.printf("%c", PacketData[i]); 
-            } 
-        wait_ms(8);
-        RS485_Mode = RS485_Read;     
-    }          
+        //UDP - UDP_endpoint holds the sender of the current datagram
+        case SOURCE_UDP:
+            UDP_server.sendTo(UDP_endpoint, frame, length);
+            break;
+            
+        //RS485
+        case SOURCE_RS485:
+            RS485.send(frame, length);
+            break;
+    }
 }
 
 //**************************************************************************
 // RS232 FUNCTIONS
 //**************************************************************************
-void writeRS232(char channel, char* data, int length)
+bool writeRS232(char channel, const char* data, int length)
 {
  
+    //Queue the whole payload into the TX ring or nothing - never waits, a full ring is an error for the sender
     switch(channel)
     {
         case 1:
-        for(int i = 0 ; i < length; i++)
-            {
-                RS232_1.printf("%c", data[i]); 
-            }        
+            return RS232_1.send(data, length);
+        case 2:
+            return RS232_2.send(data, length);
+        default:
+            return false;
+    }
+}
+
+
+//Config RS232 - baud rate (4 bytes, big endian), then data bits (5-8), parity ('N', 'O', 'E') & stop bits (1-2), or nothing
+bool configRS232(char channel, const char* data, int length)
+{
+    int baudrate;
+    int bits;
+    int stop;
+    Serial::Parity parity;
+    
+    if((length != 4) && (length != 7)) return false;
+    
+    baudrate = ((unsigned char)data[0] << 24) | ((unsigned char)data[1] << 16) | ((unsigned char)data[2] << 8) | (unsigned char)data[3];
+    if((baudrate < 300) || (baudrate > 921600)) return false;
+    
+    //Format - kept when only the baud rate is given
+    if(length == 7)
+    {
+        bits = data[4];
+        stop = data[6];
+        if((bits < 5) || (bits > 8) || (stop < 1) || (stop > 2)) return false;
+        
+        switch(data[5])
+        {
+            case 'N': parity = Serial::None; break;
+            case 'O': parity = Serial::Odd;  break;
+            case 'E': parity = Serial::Even; break;
+            default: return false;
+        }
+    }
+    
+    switch(channel)
+    {
+        case 1:
+            RS232_1.baud(baudrate);
+            if(length == 7) RS232_1.format(bits, parity, stop);
             break;   
         case 2:
-            for(int i = 0 ; i < length; i++)
-            {
-                RS232_2.printf("%c", data[i]); 
-            }  
+            RS232_2.baud(baudrate);
+            if(length == 7) RS232_2.format(bits, parity, stop);
             break;
+        default:
+            return false;
+    }
+    
+    if(logLevel >= LOG_INFO) printf("RS232_%d: %d baud\n", channel, baudrate);
+    
+    return true;
+}
+
+
+//RS232 Status
+void rs232StatusFeedback(char source)
+{
+    char data[28 * 2];
+    char reply[PACKET_MAX_SIZE];
+    int replyLength;
+    unsigned long counter[7];
+    
+    //Per port: bytes & datagrams sent, bytes dropped by the bridge, then the UART receive counters
+    for (int i = 0; i < 2; i++)
+    {
+        counter[0] = RS232_bridge[i].bytes;
+        counter[1] = RS232_bridge[i].datagrams;
+        counter[2] = RS232_bridge[i].drops;
+        if (i == 0) serialCounters(RS232_1, counter + 3);
+        else serialCounters(RS232_2, counter + 3);
+        
+        for (int j = 0; j < 7; j++)
+        {
+            data[28 * i + 4 * j + 0] = counter[j] >> 24;
+            data[28 * i + 4 * j + 1] = counter[j] >> 16;
+            data[28 * i + 4 * j + 2] = counter[j] >> 8;
+            data[28 * i + 4 * j + 3] = counter[j];
+        }
+    }
+    
+    replyLength = packetEncode(reply, deviceID, 'S', SYSTEM_RS232_STATUS, data, sizeof(data));
+    packetReply(source, reply, replyLength);
+}
+
+
+//UART receive counters: bytes or frames lost, frames received, resyncs & bad checksums in packet mode
+template<class SERIAL>
+void serialCounters(SERIAL& serial, unsigned long* counter)
+{
+    counter[0] = serial.rx_overruns + serial.rx_hw_overruns;
+    counter[1] = serial.rx_frames;
+    counter[2] = serial.rx_resyncs;
+    counter[3] = serial.rx_bad_checksums;
+}
+
+
+//RS485 Status
+void rs485StatusFeedback(char source)
+{
+    char data[4 * 11];
+    char reply[PACKET_MAX_SIZE];
+    int replyLength;
+    unsigned long counter[11];
+    
+    //Bytes & frames refused, driver enable bursts, bus occupancy in us (total, last, worst burst), bytes received, then the UART receive counters
+    counter[0] = RS485.tx_bytes;
+    counter[1] = RS485.tx_drops;
+    counter[2] = RS485.tx_bursts;
+    counter[3] = RS485.tx_busy_us;
+    counter[4] = RS485.tx_last_us;
+    counter[5] = RS485.tx_max_us;
+    counter[6] = RS485.rx_bytes;
+    serialCounters(RS485, counter + 7);
+    
+    for (int j = 0; j < 11; j++)
+    {
+        data[4 * j + 0] = counter[j] >> 24;
+        data[4 * j + 1] = counter[j] >> 16;
+        data[4 * j + 2] = counter[j] >> 8;
+        data[4 * j + 3] = counter[j];
+    }
+    
+    replyLength = packetEncode(reply, deviceID, 'S', SYSTEM_RS485_STATUS, data, sizeof(data));
+    packetReply(source, reply, replyLength);
+}
+
+
+//RS232 TCP Bridge Status
+void tcpStatusFeedback(char source)
+{
+    char data[17 * 2];
+    char reply[PACKET_MAX_SIZE];
+    int replyLength;
+    unsigned long counter[4];
+    
+    //Per port: client connected, connections, then of the current or last connection: bytes to serial, bytes from serial, duration in ms
+    for (int i = 0; i < 2; i++)
+    {
+        data[17 * i] = (i == 0) ? RS232_1_tcp.connected() : RS232_2_tcp.connected();
+        counter[0] = (i == 0) ? RS232_1_tcp.connections : RS232_2_tcp.connections;
+        counter[1] = (i == 0) ? RS232_1_tcp.rx_bytes : RS232_2_tcp.rx_bytes;
+        counter[2] = (i == 0) ? RS232_1_tcp.tx_bytes : RS232_2_tcp.tx_bytes;
+        counter[3] = (i == 0) ? RS232_1_tcp.duration_ms() : RS232_2_tcp.duration_ms();
+        
+        for (int j = 0; j < 4; j++)
+        {
+            data[17 * i + 4 * j + 1] = counter[j] >> 24;
+            data[17 * i + 4 * j + 2] = counter[j] >> 16;
+            data[17 * i + 4 * j + 3] = counter[j] >> 8;
+            data[17 * i + 4 * j + 4] = counter[j];
+        }
     }
-           
+    
+    replyLength = packetEncode(reply, deviceID, 'S', SYSTEM_TCP_STATUS, data, sizeof(data));
+    packetReply(source, reply, replyLength);
 }
 
 
@@ -641,7 +908,7 @@ void writeRS232(char channel, char* data, int length)
 //**************************************************************************
 
 //Write Relay
-void writeRelay(char channel, char value)
+bool writeRelay(char channel, char value)
 { 
     switch(channel){
         case 1:
@@ -667,36 +934,26 @@ void writeRelay(char channel, char value)
             relayStatusFeedback(channel, value); 
             break;  
         default:
+            return false;
     }  
+    
+    return true;
 }
 
 //Relay Status Feedback
 void relayStatusFeedback(char channel, char value)
 {
+    char feedbackString[PACKET_MAX_SIZE];
+    int feedbackLength;
     
-    //Clear feedbackstring
-    memset(feedbackString, 0x00, 255);   
-    
-    //Feedback received packet
-    feedbackString[0] = 62;                                                                     //Start of Data ('>')                                        
-    feedbackString[1] = deviceID;                                                               //Device ID
-    feedbackString[2] = 'S';                                                                    //Data Type : Status
-    feedbackString[3] = channel + 20;                                                           //Channel
-    feedbackString[4] = 1;                                                                      //DataLength
-    feedbackString[5] = value;                                                                  //Data
-    feedbackString[6] = feedbackString[0] + feedbackString[1] + feedbackString[2] +             //Checksum                                                     
-                        feedbackString[3] + feedbackString[4] + feedbackString[5];    
-                        
+    //Feedback received packet - Data Type : Status
+    feedbackLength = packetEncode(feedbackString, deviceID, 'S', channel + 20, &value, 1);
                         
-    //Send feedback data to UDP 
-    UDP_endpoint.set_address("192.168.1.51", UDP_PORT);   
-    UDP_server.sendTo(UDP_endpoint, feedbackString, 7);
+    //Send feedback data to UDP
+    UDP_publisher.status(channel + 20, &value, 1);
       
     //Send feedback data to RS485 
-    wait_ms(8);
-    RS485_Mode = RS485_Write;                                      
-    RS485.send_line(feedbackString); wait_ms(8);
-    RS485_Mode = RS485_Read;
+    RS485.send(feedbackString, feedbackLength);
     
      //Send feedback data to USB
     /*
@@ -713,271 +970,135 @@ void relayStatusFeedback(char channel, char value)
 //**************************************************************************
 
 //Write IR
-void writeIR(char IRPort, char IRChannel)
+bool writeIR(char IRPort, char IRChannel, int repeat)
 {        
-    //Open the file
-    switch(IRPort)
+    IRCode code;
+    char path[16];
+    
+    //Send IR Code from the cache
+    if (IR_cache.find(IRPort, IRChannel, &code))
     {
-        case 1:
-            file = fopen("/local/IR1.txt", "r");
-            break;   
-        case 2:
-            file = fopen("/local/IR2.txt", "r");
-            break; 
-        case 3:
-            file = fopen("/local/IR3.txt", "r");
-            break; 
-        case 4:
-            file = fopen("/local/IR4.txt", "r");
-            break;
-        case 5:
-            file = fopen("/local/IR5.txt", "r");
-            break;
-        case 6:
-            file = fopen("/local/IR6.txt", "r");
-            break;
-    } 
+        send_IR_Code(IRPort, code, repeat);
+        return true;
+    }
     
+    //Not cached - open the file
+    sprintf(path, "/local/IR%d.txt", IRPort);
+    file = fopen(path, "r");
     
     //Read IR Code and Send IR Code
      if (file != NULL) 
      {        
         //read the line #IRChannel
-        for (int i = 0; i < IRChannel; i++) fgets(IRCode, sizeof IRCode, file);
-
-        //parse Line & send IR Blinks
-        send_IR_Code(IRPort, IRCode);
+        for (int i = 0; i < IRChannel; i++) 
+        {
+            if (fgets(IRLine, sizeof IRLine, file) == NULL) IRLine[0] = 0;
+        }
 
         //Close the file
         fclose(file);
         
+        //parse Line & send IR Blinks - the port's own table may still be on the air, other ports don't matter
+        while (!IR_scheduler.idle(IRPort)) Thread::wait(1);
+        if (!parseIRCode(IRLine, IRTiming[IRPort - 1], IR_MAX_PAIRS, &code)) return false;
+        send_IR_Code(IRPort, code, repeat);
+        
+        return true;
     }
     else
     {
         //printf("Error: There is no IR file\n");   
+        return false;
     }   
 }
 
 
-//Parse Line & send IR Blinks
-void send_IR_Code(char IRPort, char* ptrIRCode)
+//Load IR Codes - compile /local/IR1.txt .. IR6.txt into the IR cache
+void load_IR_Codes()
 {
-    char field[8];
-    int n;
-    int index = 0;
-    int IRCodeIndex = 0; 
-    int decimal;
-    int frequency;
-    int period_us;
-    int blink_time_on_index = 0;
-    int blink_time_off_index = 0;
-    int pair_count_index = 0;
-    int pair_count = 0;
-    int Blink_time;
-    int Blink_time_On[128];
-    int Blink_time_Off[128];
-    
-    //printf("Parse IR Code:\n");
-    
-    //Parse Line with " " delimiter
-    while ( sscanf(ptrIRCode, "%1023[^ ]%n", field, &n) == 1 ) 
+    char path[16];
+    
+    //Cached codes may still be on the air
+    wait_IR_Idle();
+    IR_cache.clear();
+    
+    for (int port = 1; port <= IR_PORT_COUNT; port++)
     {
-        index++;
-        ptrIRCode += n;                     
-        if ( *ptrIRCode != ' ' ) 
-        {
-            break;                          
-        }
-        ++ptrIRCode;                       
+        sprintf(path, "/local/IR%d.txt", port);
+        IR_cache.load(port, path, IRLine, sizeof IRLine);
+    }
+    
+    if(logLevel >= LOG_INFO) printf("IR Cache: %d codes, %d/%d words\n", IR_cache.entries(), IR_cache.size(), IR_cache.capacity());
+}
 
-        //printf("Field_%d:%s\n", index,field);
 
-        //Get Frequency and set PWM
-        if (index == 2) 
-        {
-            
-            sscanf(field, "%x", &decimal );         
-            printf("Decimal:%d\n", decimal);
-            
-            //Calculate Frequency
-            //frequency = 100000000 / (decimal * 24);
-            period_us = (decimal * 0.24);
-            //printf("Frequency:%d\n", frequency);
-            //printf("Period_us:%d\n", period_us);
-            
-            //Set PWM Period -  Note: If you change one of the ports, all of them will change 
-            switch(IRPort)
-            {
-                case 1:
-                    IR1.period_us(period_us);
-                    break;   
-                case 2:
-                    IR2.period_us(period_us);
-                    break; 
-                case 3:
-                    IR3.period_us(period_us);
-                    break; 
-                case 4:
-                    IR4.period_us(period_us);
-                    break;
-                case 5:
-                    IR5.period_us(period_us);
-                    break;
-                case 6:
-                    IR6.period_us(period_us);
-                    break;
-            }      
-        }
-        
+//IR Cache Statistics
+void irCacheStatusFeedback(char source)
+{
+    char data[14];
+    char reply[PACKET_MAX_SIZE];
+    int replyLength;
+    
+    data[0] = IR_cache.entries() >> 8;      data[1] = IR_cache.entries();
+    data[2] = IR_cache.size() >> 8;         data[3] = IR_cache.size();
+    data[4] = IR_cache.capacity() >> 8;     data[5] = IR_cache.capacity();
+    data[6] = IR_cache.hits >> 24;          data[7] = IR_cache.hits >> 16;
+    data[8] = IR_cache.hits >> 8;           data[9] = IR_cache.hits;
+    data[10] = IR_cache.misses >> 24;       data[11] = IR_cache.misses >> 16;
+    data[12] = IR_cache.misses >> 8;        data[13] = IR_cache.misses;
+    
+    replyLength = packetEncode(reply, deviceID, 'S', SYSTEM_IR_CACHE, data, sizeof(data));
+    packetReply(source, reply, replyLength);
+}
 
-        //Get total pair count
-        if (index == 4) 
-        {
-            
-            sscanf(field, "%x", &decimal );        
-            //printf("Decimal:%d\n", decimal);
-            
-            //print PairCount
-            pair_count = decimal;
-            //printf("Pair Count:%d\n", pair_count);
-              
-        }
 
-        //Get IRCode
-        if (index > 4) 
-        {
-                                    
-            switch(IRCodeIndex)
-            {
-                //TurnOnBlink
-                case 0:
-                    IRCodeIndex = 1;
-                    sscanf(field, "%x", &decimal);         
-                    Blink_time = decimal*period_us;
-                    //printf("TurnOnBlink[%d]:%d us\n", blink_time_on_index, Blink_time);
-                    Blink_time_On[blink_time_on_index] = Blink_time;
-                    blink_time_on_index++;
-                    break;
-                    
-                //TurnOffBlink
-                case 1:
-                    IRCodeIndex = 0;
-                    sscanf(field, "%x", &decimal);         
-                    Blink_time = decimal*period_us;
-                    //printf("TurnOffBlink[%d]:%d us\n", blink_time_off_index, Blink_time);
-                    Blink_time_Off[blink_time_off_index] = Blink_time;
-                    blink_time_off_index++;
-                    break;
-            }  
-              
-            pair_count_index++;       
-        }            
-    } 
+//Send IR Blinks - returns as soon as the code is queued, ports sharing a carrier run concurrently
+void send_IR_Code(char IRPort, const IRCode& code, int repeat)
+{
+    if ((IRPort < 1) || (IRPort > IR_PORT_COUNT)) return;
     
-    //Send IR Signal    
-    switch(IRPort)
-    {
-        case 1:
-            //Send Pronto IR Blinks - x times
-            for(int k = 0; k  < 1; k++)
-            {
-                for(int i = 0; i < pair_count; i++)
-                {
-                    //send IR Blinks On
-                    IR1 = 0.5f;
-                    wait_us(Blink_time_On[i]);
-                    IR1= 0.0f;   
-                
-                    //send IR Blinks Off 
-                    wait_us(Blink_time_Off[i]);
-                }
-            }
-            break;   
-        case 2:
-            //Send Pronto IR Blinks - x times
-            for(int k = 0; k  < 1; k++)
-            {
-                for(int i = 0; i < pair_count; i++)
-                {
-                    //send IR Blinks On
-                    IR2 = 0.5f;
-                    wait_us(Blink_time_On[i]);
-                    IR2= 0.0f;   
-                
-                    //send IR Blinks Off 
-                    wait_us(Blink_time_Off[i]);
-                }
-            }
-            break;   
-        case 3:
-            //Send Pronto IR Blinks - 3 times
-            for(int k = 0; k  < 3; k++)
-            {
-                for(int i = 0; i < pair_count; i++)
-                {
-                    //send IR Blinks On
-                    IR3 = 0.5f;
-                    wait_us(Blink_time_On[i]);
-                    IR3= 0.0f;   
-                
-                    //send IR Blinks Off 
-                    wait_us(Blink_time_Off[i]);
-                }
-            }
-            break;   
-        case 4:
-            //Send Pronto IR Blinks - 5 times
-            for(int k = 0; k  < 5; k++)
-            {
-                for(int i = 0; i < pair_count; i++)
-                {
-                    //send IR Blinks On
-                    IR4 = 0.5f;
-                    wait_us(Blink_time_On[i]);
-                    IR4= 0.0f;   
-                
-                    //send IR Blinks Off 
-                    wait_us(Blink_time_Off[i]);
-                }
-            }
-            break;   
-        case 5:
-            //Send Pronto IR Blinks - x times
-            for(int k = 0; k  < 1; k++)
-            {
-                for(int i = 0; i < pair_count; i++)
-                {
-                    //send IR Blinks On
-                    IR5 = 0.5f;
-                    wait_us(Blink_time_On[i]);
-                    IR5= 0.0f;   
-                
-                    //send IR Blinks Off 
-                    wait_us(Blink_time_Off[i]);
-                }
-            }
-            break;   
-        case 6:
-            //Send Pronto IR Blinks - x times
-            for(int k = 0; k  < 1; k++)
-            {
-                for(int i = 0; i < pair_count; i++)
-                {
-                    //send IR Blinks On
-                    IR6 = 0.5f;
-                    wait_us(Blink_time_On[i]);
-                    IR6= 0.0f;   
-                
-                    //send IR Blinks Off 
-                    wait_us(Blink_time_Off[i]);
-                }
-            }
-            break;   
-    }   
+    //Send IR Blinks - x times or held, wait only while the port queue is full
+    while (!IR_scheduler.send(IRPort, code, repeat)) Thread::wait(1);
+}
 
-    //Clear Buffers
-    memset(Blink_time_On, 0x00, 128);
-    memset(Blink_time_Off, 0x00, 128);
+
+//Wait until no IR code is queued or sending - timing tables may be reused afterwards
+void wait_IR_Idle()
+{
+    while (!IR_scheduler.idle()) Thread::wait(1);
+}
+
+
+//IR Transmitter Status
+void irStatusFeedback(char source)
+{
+    char data[8 * IR_PORT_COUNT];
+    char reply[PACKET_MAX_SIZE];
+    int replyLength;
+    unsigned long maxError;
+    unsigned long maxLatency;
+    
+    //Per port: busy, queue depth, max queue depth, codes sent (low byte), worst timing error in us, worst queue latency in ms
+    for (int i = 0; i < IR_PORT_COUNT; i++)
+    {
+        maxError = IRTransmitters[i]->maxError_us;
+        if (maxError > 0xFFFF) maxError = 0xFFFF;
+        
+        maxLatency = IR_scheduler.maxLatency_us[i] / 1000;
+        if (maxLatency > 0xFFFF) maxLatency = 0xFFFF;
+        
+        data[8 * i + 0] = IR_scheduler.busy(i + 1);
+        data[8 * i + 1] = IR_scheduler.queued(i + 1);
+        data[8 * i + 2] = IR_scheduler.maxDepth[i];
+        data[8 * i + 3] = IRTransmitters[i]->sent;
+        data[8 * i + 4] = maxError >> 8;
+        data[8 * i + 5] = maxError;
+        data[8 * i + 6] = maxLatency >> 8;
+        data[8 * i + 7] = maxLatency;
+    }
+    
+    replyLength = packetEncode(reply, deviceID, 'S', SYSTEM_IR_STATUS, data, sizeof(data));
+    packetReply(source, reply, replyLength);
 }
 
 
@@ -985,77 +1106,152 @@ void send_IR_Code(char IRPort, char* ptrIRCode)
 // GPIO EVENTS
 //**************************************************************************
 
-//GPIO1
-void GPIO1_LowEvent()
+//GPIO Gesture - press, release, long press & double press from GPIO_gesture
+void gpioGesture(int pin, int gesture, unsigned int time_us)
 {
-    gpioStatusFeedback(1, 0);    
+    static const char* gestureName[] = { "PRESS", "RELEASE", "LONG", "DOUBLE" };
+    
+    led4 = !led4;
+    
+    //Print status
+    if(logLevel >= LOG_INFO) printf("GPIO%d %s \n", pin, gestureName[gesture]);
+    
+    gpioStatusFeedback(pin, gesture, time_us);
 }
 
-//GPIO2
-void GPIO2_LowEvent()
-{
-    gpioStatusFeedback(2, 0);   
-}
 
-//GPIO3
-void GPIO3_LowEvent()
+//GPIO Status Feedback
+void gpioStatusFeedback(char channel, char gesture, unsigned int time_us)
 {
-    gpioStatusFeedback(3, 0);     
+    char data[5];
+    
+    //Gesture & edge time in us
+    data[0] = gesture;
+    data[1] = time_us >> 24;
+    data[2] = time_us >> 16;
+    data[3] = time_us >> 8;
+    data[4] = time_us;
+    
+    //Send feedback data to UDP
+    UDP_publisher.status(channel + 10, data, sizeof(data));
 }
 
-//GPIO4
-void GPIO4_LowEvent()
-{
-    gpioStatusFeedback(4, 0);     
-}
 
-//GPIO5
-void GPIO5_LowEvent()
-{
-    gpioStatusFeedback(5, 0);     
-}
+//**************************************************************************
+// SUBSCRIBERS
+//**************************************************************************
 
-//GPIO6
-void GPIO6_LowEvent()
+//Subscribe - the UDP sender for a TTL in s (2 bytes, big endian, default SubscriberTTL), unsubscribe with a TTL of 0
+char subscribe(PacketFrame packet, char source)
 {
-    gpioStatusFeedback(6, 0);     
+    unsigned int ttl = (UDP_subscribers.ttl_s > 0) ? UDP_subscribers.ttl_s : SUBSCRIBER_TTL_S;
+    
+    if(source != SOURCE_UDP) return PACKET_STATUS_ERROR;
+    
+    if(packet.dataLength >= 2)
+    {
+        ttl = ((unsigned char)packet.data[0] << 8) | (unsigned char)packet.data[1];
+        
+        //Unsubscribe
+        if(ttl == 0)
+        {
+            UDP_subscribers.remove(UDP_endpoint);
+            return PACKET_STATUS_OK;
+        }
+    }
+    
+    if(!UDP_subscribers.add(UDP_endpoint, ttl)) return PACKET_STATUS_ERROR;
+    
+    return PACKET_STATUS_OK;
 }
 
-//GPIO7
-void GPIO7_LowEvent()
+
+//Subscriber Status
+void subscriberStatusFeedback(char source)
 {
-    gpioStatusFeedback(7, 0);    
+    char data[12 * SUBSCRIBER_COUNT];
+    char reply[PACKET_MAX_SIZE];
+    int replyLength;
+    int length = 0;
+    int ip[4];
+    int port;
+    long ttl;
+    Subscribers::Subscriber subscriber;
+    
+    //Per live subscriber: IP address, port, seconds left (0xFFFF = permanent), datagrams dropped
+    for (int i = 0; i < SUBSCRIBER_COUNT; i++)
+    {
+        if (!UDP_subscribers.get(i, &subscriber)) continue;
+        if (sscanf(subscriber.endpoint.get_address(), "%d.%d.%d.%d", &ip[0], &ip[1], &ip[2], &ip[3]) != 4) continue;
+        
+        port = subscriber.endpoint.get_port();
+        ttl = subscriber.permanent ? 0xFFFF : (long)(subscriber.expires - time(NULL));
+        if (ttl > 0xFFFF) ttl = 0xFFFF;
+        
+        data[length++] = ip[0];
+        data[length++] = ip[1];
+        data[length++] = ip[2];
+        data[length++] = ip[3];
+        data[length++] = port >> 8;
+        data[length++] = port;
+        data[length++] = ttl >> 8;
+        data[length++] = ttl;
+        data[length++] = subscriber.drops >> 24;
+        data[length++] = subscriber.drops >> 16;
+        data[length++] = subscriber.drops >> 8;
+        data[length++] = subscriber.drops;
+    }
+    
+    replyLength = packetEncode(reply, deviceID, 'S', SYSTEM_SUBSCRIBE, data, length);
+    packetReply(source, reply, replyLength);
 }
 
-//GPIO8
-void GPIO8_LowEvent()
+
+//**************************************************************************
+// SNAPSHOT
+//**************************************************************************
+
+//Serial port state - baud rate, framing, flags (bit 0 TCP client, bit 1 transmitting)
+void snapshotSerial(char* data, int baudrate, int framing, bool client, bool transmitting)
 {
-    gpioStatusFeedback(8, 0);  
+    data[0] = baudrate >> 24;
+    data[1] = baudrate >> 16;
+    data[2] = baudrate >> 8;
+    data[3] = baudrate;
+    data[4] = framing;
+    data[5] = (client ? 0x01 : 0x00) | (transmitting ? 0x02 : 0x00);
 }
 
 
-//GPIO Status Feedback
-void gpioStatusFeedback(char channel, char value)
+//Snapshot - version, then relays, GPIO levels & busy IR ports as bit masks (bit n = channel n + 1), then RS232_1, RS232_2 & RS485
+//The version is the sequence of the last published change - read first, so the state is at least that recent
+void snapshotFeedback(char source)
 {
+    char data[7 + 3 * 6];
+    char reply[PACKET_MAX_SIZE];
+    int replyLength;
+    unsigned long version = UDP_publisher.version();
+    char irBusy = 0;
+    
+    for (int i = 0; i < IR_PORT_COUNT; i++)
+    {
+        if (IR_scheduler.busy(i + 1) || (IR_scheduler.queued(i + 1) > 0)) irBusy |= 1 << i;
+    }
+    
+    data[0] = version >> 24;
+    data[1] = version >> 16;
+    data[2] = version >> 8;
+    data[3] = version;
+    data[4] = (statusRelay1 ? 0x01 : 0x00) | (statusRelay2 ? 0x02 : 0x00) | (statusRelay3 ? 0x04 : 0x00);
+    data[5] = GPIO_input.state();
+    data[6] = irBusy;
     
-    //Clear feedbackstring
-    memset(feedbackString, 0x00, 255);   
-    
-    //Feedback received packet
-    feedbackString[0] = 62;                                                                     //Start of Data ('>')                                        
-    feedbackString[1] = deviceID;                                                               //Device ID
-    feedbackString[2] = 'S';                                                                    //Data Type : Status
-    feedbackString[3] = channel + 10;                                                           //Channel
-    feedbackString[4] = 1;                                                                      //DataLength
-    feedbackString[5] = value;                                                                  //Data
-    feedbackString[6] = feedbackString[0] + feedbackString[1] + feedbackString[2] +             //Checksum                                                     
-                        feedbackString[3] + feedbackString[4] + feedbackString[5];    
-    
-    //Set UDP Endpoint
-    UDP_endpoint.set_address("192.168.1.51", UDP_PORT);
-                                                    
-    //Send feedback data to UDP    
-    UDP_server.sendTo(UDP_endpoint, feedbackString, 7);    
+    snapshotSerial(data + 7, RS232_1.baud_rate(), RS232_1.framing_mode(), RS232_1_tcp.connected(), RS232_1.tx_busy());
+    snapshotSerial(data + 13, RS232_2.baud_rate(), RS232_2.framing_mode(), RS232_2_tcp.connected(), RS232_2.tx_busy());
+    snapshotSerial(data + 19, RS485.baud_rate(), RS485.framing_mode(), false, RS485.tx_busy());
+    
+    replyLength = packetEncode(reply, deviceID, 'S', SYSTEM_SNAPSHOT, data, sizeof(data));
+    packetReply(source, reply, replyLength);
 }
 
 
@@ -1075,10 +1271,8 @@ void read_ConfigFile()
     {
         
         //read the line #1,#2,#3,#4,#5,#6
-        for (int i = 0; i < 6; i++)
+        for (int i = 0; (i < 6) && (fgets(line, 64, file) != NULL); i++)
         { 
-            fgets(line, 64, file);
-            
             switch(i)
             {
                 case 0: 
@@ -1114,6 +1308,93 @@ void read_ConfigFile()
             }
             
         }
+        
+        //read the optional "Key:Value" lines
+        while (fgets(line, 64, file) != NULL)
+        {
+            string key = parse_Key(line);
+            
+            if (key == "LogLevel")
+            {
+                logLevel = atoi(parse_Line(line).c_str());
+                printf("LogLevel: %d\n", logLevel);
+            }
+            else if (key == "LongPress")
+            {
+                GPIO_gesture.longPress_ms = atoi(parse_Line(line).c_str());
+                printf("LongPress: %d ms\n", GPIO_gesture.longPress_ms);
+            }
+            else if (key == "DoublePress")
+            {
+                GPIO_gesture.doublePress_ms = atoi(parse_Line(line).c_str());
+                printf("DoublePress: %d ms\n", GPIO_gesture.doublePress_ms);
+            }
+            else if ((key == "RS232Port1Framing") || (key == "RS232Port2Framing"))
+            {
+                int port = (key == "RS232Port1Framing") ? 0 : 1;
+                
+                if (parse_Framing(parse_Line(line), &RS232Framing[port], &RS232FramingParameter[port]))
+                {
+                    printf("%s: %d 0x%X\n", key.c_str(), RS232Framing[port], RS232FramingParameter[port]);
+                }
+                else
+                {
+                    printf("Error: %s", line);
+                }
+            }
+            else if ((key == "RS232Port1Window") || (key == "RS232Port2Window"))
+            {
+                int port = (key == "RS232Port1Window") ? 0 : 1;
+                
+                RS232_bridge[port].window_ms = atoi(parse_Line(line).c_str());
+                printf("%s: %d ms\n", key.c_str(), RS232_bridge[port].window_ms);
+            }
+            else if (key == "Subscriber")
+            {
+                char address[16];
+                int port = UDP_PORT;
+                
+                //"Subscriber:192.168.1.51:" or "Subscriber:192.168.1.51 51984:" - permanent
+                if ((sscanf(parse_Line(line).c_str(), "%15s %d", address, &port) >= 1) && UDP_subscribers.add(address, port, SUBSCRIBER_PERMANENT))
+                {
+                    printf("Subscriber: %s %d\n", address, port);
+                }
+                else
+                {
+                    printf("Error: %s", line);
+                }
+            }
+            else if (key == "MulticastGroup")
+            {
+                char address[16];
+                
+                //"MulticastGroup:239.255.0.1:" or "MulticastGroup:239.255.0.1 51984:"
+                if (sscanf(parse_Line(line).c_str(), "%15s %d", address, &MulticastPort) >= 1)
+                {
+                    MulticastGroup = address;
+                    printf("MulticastGroup: %s %d\n", address, MulticastPort);
+                }
+            }
+            else if (key == "SubscriberTTL")
+            {
+                UDP_subscribers.ttl_s = atoi(parse_Line(line).c_str());
+                printf("SubscriberTTL: %d s\n", UDP_subscribers.ttl_s);
+            }
+            else if ((key == "RS232Port1TcpPort") || (key == "RS232Port2TcpPort"))
+            {
+                int port = (key == "RS232Port1TcpPort") ? 0 : 1;
+                
+                RS232TcpPort[port] = atoi(parse_Line(line).c_str());
+                printf("%s: %d\n", key.c_str(), RS232TcpPort[port]);
+            }
+            else if ((key == "RS232Port1WindowSize") || (key == "RS232Port2WindowSize"))
+            {
+                int port = (key == "RS232Port1WindowSize") ? 0 : 1;
+                
+                RS232_bridge[port].size = atoi(parse_Line(line).c_str());
+                printf("%s: %d bytes\n", key.c_str(), RS232_bridge[port].size);
+            }
+        }
 
         //Close the file
         fclose(file);
@@ -1155,4 +1436,83 @@ string parse_Line(const char* ptrLine)
     }
     
     return returnStr;
+}
+
+
+//Parse Key
+string parse_Key(const char* ptrLine)
+{
+    char field[64];
+    string returnStr;
+
+    //Get the string before the ":" delimiter
+    if ( sscanf(ptrLine, "%63[^:]", field) == 1 ) 
+    {
+        returnStr = field;
+    }
+    
+    return returnStr;
+}
+
+
+//Parse Framing - "PACKET", "TERMINATOR 0D0A" (hex, 1 or 2 bytes), "IDLE 20" (ms), "FIXED 5" or "FIXED 5 3E" (start byte in hex), "PASSTHROUGH"
+bool parse_Framing(const string& value, int* mode, unsigned int* parameter)
+{
+    char name[16];
+    unsigned int number = 0;
+    unsigned int start = 0;
+    int fields;
+    
+    fields = sscanf(value.c_str(), "%15s %x", name, &number);
+    if (fields < 1) return false;
+    
+    if (strcmp(name, "PACKET") == 0)
+    {
+        *mode = SERIAL_FRAME_PACKET;
+        *parameter = 0;
+    }
+    else if (strcmp(name, "PASSTHROUGH") == 0)
+    {
+        *mode = SERIAL_FRAME_PASSTHROUGH;
+        *parameter = 0;
+    }
+    else if ((strcmp(name, "TERMINATOR") == 0) && (fields == 2) && (number > 0) && (number <= 0xFFFF))
+    {
+        *mode = SERIAL_FRAME_TERMINATOR;
+        *parameter = number;
+    }
+    else if ((strcmp(name, "IDLE") == 0) && (sscanf(value.c_str(), "%*s %u", &number) == 1) && (number > 0))
+    {
+        *mode = SERIAL_FRAME_IDLE;
+        *parameter = number * 1000;
+    }
+    else if ((strcmp(name, "FIXED") == 0) && ((fields = sscanf(value.c_str(), "%*s %u %x", &number, &start)) >= 1) && (number > 0) && (number <= 0xFFFF) && (start <= 0xFF))
+    {
+        *mode = SERIAL_FRAME_FIXED;
+        *parameter = (fields == 2) ? number | SERIAL_FRAME_START(start) : number;
+    }
+    else
+    {
+        return false;
+    }
+    
+    return true;
+}
+
+
+//**************************************************************************
+// LOG
+//**************************************************************************
+
+//Print a received packet at debug log level
+void logPacket(const char* title, const char* buffer, int length)
+{
+    if (logLevel < LOG_DEBUG) return;
+    
+    printf("%s", title);
+    for(int i = 0 ; i < length; i++)
+    {
+        printf("%c", buffer[i]); 
+    }
+    printf("\n");
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include <string.h>
+#include "host.h"
+#include "Debouncer.h"
+
+#define TRACE_PATH      "data/bounce.txt"
+#define TRACE_COUNT     128
+#define TRACE_EDGES     64
+#define TICK_US         1500                // GPIO_TICK_US
+#define SETTLE_US       30000               // stable level around every trace
+#define BENCH_NS        500e6               // time per measurement
+
+//**************************************************************************
+//DEBOUNCER REPLAY
+//**************************************************************************
+// Replays the bounce traces of data/bounce.txt through the Debouncer at the
+// GPIO tick, on a different input each time and at every sample phase
+
+struct Trace
+{
+    int level;                              // before the first edge
+    int count;
+    int time_us[TRACE_EDGES];
+};
+
+static Trace traces[TRACE_COUNT];
+static int traceCount = 0;
+
+static void loadTraces()
+{
+    FILE* file = fopen(TRACE_PATH, "r");
+    char line[1024];
+    char* field;
+    Trace* trace;
+
+    CHECK(file != NULL);
+    if (file == NULL) return;
+
+    while ((traceCount < TRACE_COUNT) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        if ((line[0] == '#') || (line[0] == '\n')) continue;
+
+        trace = &traces[traceCount++];
+        trace->level = strtol(line, &field, 10);
+        trace->count = 0;
+        while ((trace->count < TRACE_EDGES) && (*field != '\n') && (*field != 0))
+        {
+            trace->time_us[trace->count++] = strtol(field, &field, 10);
+        }
+    }
+
+    fclose(file);
+}
+
+//Level of the contact t us after the first edge
+static int levelAt(const Trace& trace, int t)
+{
+    int edges = 0;
+
+    while ((edges < trace.count) && (trace.time_us[edges] <= t)) edges++;
+    return trace.level ^ (edges & 1);
+}
+
+static void replay()
+{
+    Debouncer debouncer(0xFFFFFFFF);
+    unsigned int stable = 0xFFFFFFFF;
+    unsigned int sample;
+    unsigned int changed;
+    unsigned int bit;
+    int flips;
+    int flip_us;
+    int last_us;
+    int delay_us;
+    int max_delay_us = 0;
+    int presses = 0;
+    int glitches = 0;
+
+    for (int i = 0; i < traceCount; i++)
+    {
+        const Trace& trace = traces[i];
+
+        for (int phase = 0; phase < TICK_US; phase += 100)
+        {
+            bit = 1 << ((i + phase / 100) % 32);
+
+            //Settle on the level before the edge
+            stable = (stable & ~bit) | (trace.level ? bit : 0);
+            for (int t = 0; t < SETTLE_US; t += TICK_US) debouncer.update(stable);
+            CHECK(debouncer.state() == stable);
+
+            //Bounce
+            last_us = trace.time_us[trace.count - 1];
+            flips = 0;
+            flip_us = 0;
+            for (int t = -phase; t < last_us + SETTLE_US; t += TICK_US)
+            {
+                sample = (stable & ~bit) | (levelAt(trace, t) ? bit : 0);
+                changed = debouncer.update(sample);
+
+                CHECK((changed & ~bit) == 0);
+                if (changed)
+                {
+                    flips++;
+                    flip_us = t;
+                }
+            }
+
+            //A press or release flips once, at most DEBOUNCE_SAMPLES ticks after the last bounce - a glitch never flips
+            if (trace.count & 1)
+            {
+                CHECK(flips == 1);
+                delay_us = flip_us - last_us;
+                CHECK((flip_us >= (DEBOUNCE_SAMPLES - 1) * TICK_US) && (delay_us <= DEBOUNCE_SAMPLES * TICK_US));
+                if (delay_us > max_delay_us) max_delay_us = delay_us;
+                stable ^= bit;
+                presses++;
+            }
+            else
+            {
+                CHECK(flips == 0);
+                glitches++;
+            }
+            CHECK(debouncer.state() == stable);
+        }
+    }
+
+    printf("%d edges & %d glitches replayed, longest delay after the last bounce %.1f ms\n",
+           presses, glitches, max_delay_us / 1000.0);
+}
+
+int main()
+{
+    Debouncer debouncer;
+    unsigned int sample = 0x12345678;
+    volatile unsigned int changes = 0;
+    double start;
+    double elapsed;
+    long ticks = 0;
+
+    loadTraces();
+    CHECK(traceCount > 0);
+    replay();
+
+    //One tick of 32 inputs, every input toggling now & then
+    start = host_now_ns();
+    do
+    {
+        for (int i = 0; i < 4096; i++)
+        {
+            sample ^= (sample << 13) ^ (sample >> 17) ^ (sample << 5);
+            changes |= debouncer.update((i & 8) ? sample : ~sample);
+        }
+        ticks += 4096;
+        elapsed = host_now_ns() - start;
+    } while (elapsed < BENCH_NS);
+
+    printf("Debouncer::update: %.1f ns/tick for 32 inputs\n", elapsed / ticks);
+
+    return host_failures();
+}
@@ -0,0 +1,32 @@
+#ifndef host_H
+#define host_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+//**************************************************************************
+//HOST TEST HELPERS
+//**************************************************************************
+// Failed checks are counted and printed, main() returns host_failures()
+
+static int host_failed = 0;
+
+#define CHECK(condition) \
+    do { if (!(condition)) { host_failed++; printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); } } while (0)
+
+static inline int host_failures()
+{
+    printf("%s\n", host_failed ? "FAILED" : "OK");
+    return host_failed ? 1 : 0;
+}
+
+static inline double host_now_ns()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+#endif
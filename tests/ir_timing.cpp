@@ -0,0 +1,248 @@
+#include <math.h>
+#include "host.h"
+#include "mbed.h"
+#include "us_ticker_api.h"
+#include "IRCode.h"
+#include "IRSequence.h"
+#include "IRTransmitter.h"
+
+#define EDGE_MAX        4096
+#define LATENCY_US      20                  // usual interrupt entry delay
+#define LATE_US         150                 // now & then - another interrupt or the RTX tick
+#define LATE_PERCENT    2
+
+//**************************************************************************
+//IR WAVEFORM TIMING
+//**************************************************************************
+// Sends codes through IRTransmitter on a simulated us ticker whose
+// interrupts fire a random time after they are due, and compares every
+// PWM edge with the edge times the IRSequence durations add up to. The
+// error of an edge must stay within one interrupt latency however long
+// the code - a timer re-armed from the interrupt entry time would drift
+// by the sum of all latencies, which is printed for comparison. The
+// ticker wraps in the middle of every code.
+
+mbed::Simulation mbed::simulation;
+
+static uint32_t edges[EDGE_MAX];
+static int edgeCount;
+static unsigned int seed = 6;
+
+static void pwmWrite(PwmOut*, float)
+{
+    if (edgeCount < EDGE_MAX) edges[edgeCount++] = simulation.now_us;
+}
+
+static unsigned int latency()
+{
+    seed = seed * 1103515245 + 12345;
+    if ((seed >> 16) % 100 < LATE_PERCENT) return (seed >> 8) % (LATE_US + 1);
+    return (seed >> 8) % (LATENCY_US + 1);
+}
+
+//Run the interrupts until the transmitter is idle - returns the sum of all latencies
+static unsigned long run(IRTransmitter& transmitter)
+{
+    Timeout* next;
+    unsigned int delay;
+    unsigned long total = 0;
+
+    while (transmitter.busy())
+    {
+        next = NULL;
+        for (int i = 0; i < simulation.timeoutCount; i++)
+        {
+            Timeout* t = simulation.timeouts[i];
+            if (t->armed && ((next == NULL) || ((int)(t->due_us - next->due_us) < 0))) next = t;
+        }
+        CHECK(next != NULL);
+        if (next == NULL) break;
+
+        delay = latency();
+        total += delay;
+        simulation.now_us = next->due_us + delay;
+        next->armed = false;
+        next->handler.call();
+    }
+
+    return total;
+}
+
+//Send code repeat times & check every edge against the durations of its frames
+static void checkCode(const char* name, const char* line, int repeat)
+{
+    static PwmOut pwm;
+    unsigned short timing[2 * IR_MAX_PAIRS];
+    IRTransmitter transmitter(pwm);
+    IRSequence sequence;
+    IRCode code;
+    unsigned int duration;
+    uint32_t ideal;
+    unsigned long drift;
+    unsigned int error;
+    unsigned int maxError = 0;
+    int count = 0;
+
+    CHECK(parseIRCode(line, timing, IR_MAX_PAIRS, &code));
+
+    //Start close to the ticker wrap
+    simulation.now_us = 0xFFFFFFFF - 20000;
+    edgeCount = 0;
+    CHECK(transmitter.send(code, repeat));
+    drift = run(transmitter);
+
+    //First edge at the start, then one per duration & the final off
+    ideal = edges[0];
+    for (int frame = 0; frame < repeat; frame++)
+    {
+        sequence.start(&code, frame > 0);
+        while (sequence.next(&duration))
+        {
+            ideal += duration;
+            count++;
+            if (count >= edgeCount) break;
+
+            error = edges[count] - ideal;
+            CHECK(error <= LATE_US);
+            if (error > maxError) maxError = error;
+        }
+    }
+
+    CHECK(count + 1 == edgeCount);
+    CHECK(transmitter.maxError_us == maxError);
+    CHECK(transmitter.sent == 1);
+
+    printf("%-7s x%d: %4d edges over %6.1f ms, worst edge %3u us late, re-armed from entry %6lu us\n",
+           name, repeat, edgeCount, (edges[edgeCount - 1] - edges[0]) / 1000.0, maxError, drift);
+}
+
+//**************************************************************************
+//PROTOCOL ENCODERS
+//**************************************************************************
+// IRSequence of a protocol code against the same code as Pronto timing:
+// lines of data/pronto.txt built from the protocol specs, and one RC6 frame
+// written out from its IRP, RC6-0-16
+//   {36k,444,msb}<-1,1|1,-1>(6,-2,1:1,0:3,<-2,2|2,-2>(T:1),D:8,F:8,^107m)
+// Every mark & space must agree within a carrier period, and the frame -
+// up to the end of its final gap - within 1%, the rounding of the Pronto
+// cycle counts adds up over a frame. RC5/RC6 toggle: the first code of a
+// sequence sends 1.
+
+#define RC6_00_0C_T1    "0000 0073 0000 0014 0060 0020 0010 0020 0010 0010 0010 0010 0030 0030 " \
+                        "0010 0010 0010 0010 0010 0010 0010 0010 0010 0010 0010 0010 0010 0010 " \
+                        "0010 0010 0010 0010 0010 0010 0010 0010 0020 0010 0010 0020 0010 0010 0010 0BCB"
+
+struct KnownCode
+{
+    const char* code;
+    int line;                               // of data/pronto.txt, 0 = pronto
+    const char* pronto;
+    int toggle;
+};
+
+static const KnownCode knownCodes[] =
+{
+    { "NEC A5 4D",      1,  NULL,           1 },
+    { "NEC CA 18",      2,  NULL,           1 },
+    { "NEC 9D 5C",      16, NULL,           1 },
+    { "RC5 06 18",      17, NULL,           0 },
+    { "RC5 17 0C",      18, NULL,           1 },
+    { "RC5 0D 3F",      20, NULL,           1 },
+    { "RC5 1A 05",      32, NULL,           1 },
+    { "SIRC12 04 50",   33, NULL,           1 },
+    { "SIRC12 1F 74",   35, NULL,           1 },
+    { "SIRC12 1F 14",   48, NULL,           1 },
+    { "RC6 00 0C",      0,  RC6_00_0C_T1,   1 },
+};
+
+//One frame of the protocol code against pairs of the Pronto timing
+static void checkFrame(const char* name, IRSequence& sequence, const IRCode& pronto, int first, int count)
+{
+    double period_us = pronto.carrier * 0.241246;
+    double expected;
+    double frame_us = 0;
+    double prontoFrame_us = 0;
+    unsigned int duration;
+    int steps = 0;
+
+    while ((steps < 2 * count) && sequence.next(&duration))
+    {
+        expected = pronto.timing[2 * first + steps] * period_us;
+        frame_us += duration;
+        prontoFrame_us += expected;
+
+        //Marks & spaces - the final gap only fills up the frame period
+        if ((steps < 2 * count - 1) && (fabs(duration - expected) > period_us))
+        {
+            printf("%s: step %d is %u us, %.0f us in Pronto\n", name, steps, duration, expected);
+            CHECK(false);
+        }
+        steps++;
+    }
+
+    CHECK(steps == 2 * count);
+    CHECK(!sequence.next(&duration));
+    CHECK(fabs(frame_us - prontoFrame_us) <= prontoFrame_us / 100);
+}
+
+static void checkEncoders()
+{
+    FILE* file;
+    char lines[48][1024];
+    int lineCount = 0;
+    unsigned short timing[2 * IR_MAX_PAIRS];
+    IRCode code;
+    IRCode pronto;
+
+    file = fopen("data/pronto.txt", "r");
+    CHECK(file != NULL);
+    if (file == NULL) return;
+    while ((lineCount < 48) && (fgets(lines[lineCount], sizeof(lines[0]), file) != NULL)) lineCount++;
+    fclose(file);
+
+    for (unsigned int i = 0; i < sizeof(knownCodes) / sizeof(knownCodes[0]); i++)
+    {
+        const KnownCode& known = knownCodes[i];
+        IRSequence sequence;
+
+        CHECK(parseProtocolCode(known.code, &code));
+        CHECK(parseProntoCode(known.line ? lines[known.line - 1] : known.pronto, timing, IR_MAX_PAIRS, &pronto));
+        CHECK(code.carrier == pronto.carrier);
+
+        //First frame - the once sequence, or the repeat sequence if there is none
+        sequence.start(&code, false);
+        if (known.toggle == 0) sequence.start(&code, false);
+        if (pronto.onceCount > 0) checkFrame(known.code, sequence, pronto, 0, pronto.onceCount);
+        else checkFrame(known.code, sequence, pronto, 0, pronto.repeatCount);
+
+        //Repeat frame
+        sequence.start(&code, true);
+        checkFrame(known.code, sequence, pronto, pronto.onceCount, pronto.repeatCount);
+    }
+
+    printf("%d protocol codes match their Pronto timing\n", (int)(sizeof(knownCodes) / sizeof(knownCodes[0])));
+}
+
+int main()
+{
+    FILE* file;
+    char line[1024];
+
+    simulation.pwmWrite = pwmWrite;
+
+    checkEncoders();
+
+    checkCode("NEC", "NEC 04 08", 3);
+    checkCode("RC5", "RC5 05 35", 3);
+    checkCode("RC6", "RC6 04 0C", 3);
+    checkCode("SIRC12", "SIRC12 01 15", 3);
+    checkCode("SIRC20", "SIRC20 0101 15", 3);
+
+    //A learned Pronto code with a repeat sequence
+    file = fopen("data/pronto.txt", "r");
+    CHECK(file != NULL);
+    if ((file != NULL) && (fgets(line, sizeof(line), file) != NULL)) checkCode("Pronto", line, 5);
+    if (file != NULL) fclose(file);
+
+    return host_failures();
+}
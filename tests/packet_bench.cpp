@@ -0,0 +1,95 @@
+#include <string.h>
+#include "host.h"
+#include "PacketCodec.h"
+
+#define FRAME_COUNT     1024
+#define BENCH_NS        500e6               // time per measurement
+
+//**************************************************************************
+//PACKET DECODE BENCHMARK
+//**************************************************************************
+// Frames/s of packetDecode over a mix of command sizes, plus the codec checks
+
+static char frames[FRAME_COUNT][PACKET_MAX_SIZE];
+static int lengths[FRAME_COUNT];
+
+static void checkCodec()
+{
+    char data[PACKET_MAX_DATA];
+    char frame[PACKET_MAX_SIZE];
+    char batch[32];
+    PacketFrame packet;
+    PacketFrame command;
+    int length;
+    int offset = 0;
+
+    for (int i = 0; i < PACKET_MAX_DATA; i++) data[i] = i * 7;
+
+    //Roundtrip of every data length
+    for (int n = 0; n <= PACKET_MAX_DATA; n++)
+    {
+        length = packetEncode(frame, 3, 'W', 21, data, n);
+        CHECK(length == n + PACKET_OVERHEAD);
+        CHECK(packetDecode(frame, length, &packet));
+        CHECK((packet.deviceID == 3) && (packet.dataType == 'W') && (packet.channel == 21));
+        CHECK((packet.dataLength == n) && (memcmp(packet.data, data, n) == 0));
+    }
+    CHECK(packetEncode(frame, 3, 'W', 21, data, PACKET_MAX_DATA + 1) == 0);
+
+    //Corrupt frames
+    length = packetEncode(frame, 3, 'W', 21, data, 10);
+    CHECK(!packetDecode(frame, length - 1, &packet));
+    frame[PACKET_HEADER_SIZE]++;
+    CHECK(!packetDecode(frame, length, &packet));
+    frame[PACKET_HEADER_SIZE]--;
+    frame[0] = '<';
+    CHECK(!packetDecode(frame, length, &packet));
+
+    //Batch of two commands & a malformed tail
+    memcpy(batch, "W\x15\x01\x01R\x0b\x00W\x16\x05", 10);
+    length = packetEncode(frame, 3, PACKET_TYPE_BATCH, 0, batch, 10);
+    CHECK(packetDecode(frame, length, &packet));
+    CHECK(packetBatchNext(packet, &offset, &command) && (command.channel == 21) && (command.dataLength == 1));
+    CHECK(packetBatchNext(packet, &offset, &command) && (command.channel == 11) && (command.dataLength == 0));
+    CHECK(!packetBatchNext(packet, &offset, &command) && (offset == 7));
+}
+
+int main()
+{
+    static const int sizes[] = { 1, 1, 2, 4, 8, 16, 64, PACKET_MAX_DATA };
+    char data[PACKET_MAX_DATA];
+    PacketFrame packet;
+    double start;
+    double elapsed;
+    long decoded = 0;
+    long bytes = 0;
+    long valid = 0;
+
+    checkCodec();
+
+    //Mostly short commands, now & then a full RS232 payload
+    for (int i = 0; i < PACKET_MAX_DATA; i++) data[i] = rand();
+    for (int i = 0; i < FRAME_COUNT; i++)
+    {
+        lengths[i] = packetEncode(frames[i], 1, 'W', 31, data, sizes[i % 8]);
+    }
+
+    start = host_now_ns();
+    do
+    {
+        for (int i = 0; i < FRAME_COUNT; i++)
+        {
+            valid += packetDecode(frames[i], lengths[i], &packet);
+            bytes += lengths[i];
+        }
+        decoded += FRAME_COUNT;
+        elapsed = host_now_ns() - start;
+    } while (elapsed < BENCH_NS);
+
+    CHECK(valid == decoded);
+
+    printf("packetDecode: %.0f frames/s, %.1f MB/s, %.1f ns/frame\n",
+           decoded / elapsed * 1e9, bytes / elapsed * 1e3, elapsed / decoded);
+
+    return host_failures();
+}
@@ -0,0 +1,220 @@
+#include <string.h>
+#include "host.h"
+#include "IRCode.h"
+
+#define CORPUS_PATH     "data/pronto.txt"
+#define FULL_PATH       "build/ir_full.txt"
+#define CORPUS_LINES    64
+#define LINE_SIZE       1024
+#define BENCH_NS        500e6               // time per measurement
+
+//**************************************************************************
+//PRONTO PARSE BENCHMARK
+//**************************************************************************
+// parseProntoCode against the sscanf parser it replaced, over the codes of
+// data/pronto.txt (NEC, RC5 & SIRC12 built from their protocol timing)
+
+static char corpus[CORPUS_LINES][LINE_SIZE];
+static int corpusLines = 0;
+
+//send_IR_Code of the first release without the PWM calls - on & off times in us
+//The last word is only kept when a blank follows it
+static int legacyParse(char* ptrIRCode, int* Blink_time_On, int* Blink_time_Off)
+{
+    char field[8];
+    int n;
+    int index = 0;
+    int IRCodeIndex = 0;
+    int decimal;
+    int period_us = 0;
+    int blink_time_on_index = 0;
+    int blink_time_off_index = 0;
+    int pair_count = 0;
+
+    while ( sscanf(ptrIRCode, "%7[^ ]%n", field, &n) == 1 )
+    {
+        index++;
+        ptrIRCode += n;
+        if ( *ptrIRCode != ' ' ) break;
+        ++ptrIRCode;
+
+        if (index == 2)
+        {
+            sscanf(field, "%x", &decimal );
+            period_us = (decimal * 0.24);
+        }
+
+        if (index == 4)
+        {
+            sscanf(field, "%x", &decimal );
+            pair_count = decimal;
+        }
+
+        if (index > 4)
+        {
+            sscanf(field, "%x", &decimal);
+            if (IRCodeIndex == 0) Blink_time_On[blink_time_on_index++] = decimal * period_us;
+            else Blink_time_Off[blink_time_off_index++] = decimal * period_us;
+            IRCodeIndex = !IRCodeIndex;
+        }
+    }
+
+    (void)pair_count;
+    return blink_time_on_index;
+}
+
+static void loadCorpus()
+{
+    FILE* file = fopen(CORPUS_PATH, "r");
+
+    CHECK(file != NULL);
+    if (file == NULL) return;
+
+    while ((corpusLines < CORPUS_LINES) && (fgets(corpus[corpusLines], LINE_SIZE, file) != NULL)) corpusLines++;
+    fclose(file);
+}
+
+//Both parsers must agree on every time the old one produced
+static void checkParsers()
+{
+    unsigned short timing[2 * IR_MAX_PAIRS];
+    int on[IR_MAX_PAIRS];
+    int off[IR_MAX_PAIRS];
+    char line[LINE_SIZE];
+    IRCode code;
+    int pairs;
+    int period_us;
+
+    for (int i = 0; i < corpusLines; i++)
+    {
+        CHECK(parseProntoCode(corpus[i], timing, IR_MAX_PAIRS, &code));
+        strcpy(line, corpus[i]);
+        pairs = legacyParse(line, on, off);
+        CHECK(pairs == code.pairCount());
+
+        period_us = code.carrier * 0.24;
+        for (int j = 0; j < pairs; j++)
+        {
+            CHECK(on[j] == timing[2 * j] * period_us);
+            if (j < pairs - 1) CHECK(off[j] == timing[2 * j + 1] * period_us);
+        }
+    }
+
+    //Rejected lines
+    CHECK(!parseProntoCode("0000 006D 0001", timing, IR_MAX_PAIRS, &code));
+    CHECK(!parseProntoCode("0000 006D 0002 0000 0156 00AB", timing, IR_MAX_PAIRS, &code));
+    CHECK(!parseProntoCode("0100 006D 0001 0000 0156 00AB", timing, IR_MAX_PAIRS, &code));
+    CHECK(!parseProntoCode("0000 006D 0001 0000 0156 0G", timing, IR_MAX_PAIRS, &code));
+    CHECK(!parseProntoCode("0000 006D 0001 0000 00156 00AB", timing, IR_MAX_PAIRS, &code));
+}
+
+//The cache compiles the same file line for line
+static void checkCache()
+{
+    IRCodeCache cache;
+    char line[LINE_SIZE];
+    unsigned short timing[2 * IR_MAX_PAIRS];
+    IRCode cached;
+    IRCode parsed;
+    int loaded;
+
+    cache.clear();
+    loaded = cache.load(1, CORPUS_PATH, line, sizeof(line));
+    CHECK((loaded == corpusLines) && (cache.size() <= cache.capacity()));
+
+    for (int i = 0; i < loaded; i++)
+    {
+        CHECK(cache.find(1, i + 1, &cached));
+        CHECK(parseProntoCode(corpus[i], timing, IR_MAX_PAIRS, &parsed));
+        CHECK((cached.carrier == parsed.carrier) && (cached.pairCount() == parsed.pairCount()));
+        CHECK(memcmp(cached.timing, timing, 4 * parsed.pairCount()) == 0);
+    }
+    CHECK(!cache.find(1, loaded + 1, &cached));
+    CHECK(!cache.find(2, 1, &cached));
+}
+
+//A full pool still caches protocol codes & Pronto codes that fit the space left
+static void checkCacheFull()
+{
+    IRCodeCache cache;
+    char line[LINE_SIZE];
+    IRCode cached;
+    FILE* file;
+    int fit;
+
+    //NEC Pronto codes until past the pool, then protocol codes & a short RC5 Pronto code
+    fit = IR_CACHE_SIZE / 72;
+    file = fopen(FULL_PATH, "w");
+    CHECK(file != NULL);
+    if (file == NULL) return;
+    for (int i = 0; i < fit + 2; i++) fputs(corpus[0], file);
+    fputs("NEC 04 08\n", file);
+    fputs("SIRC12 01 15\n", file);
+    fputs(corpus[16], file);
+    fclose(file);
+
+    cache.clear();
+    CHECK(cache.load(1, FULL_PATH, line, sizeof(line)) == fit + 5);
+
+    for (int i = 1; i <= fit; i++) CHECK(cache.find(1, i, &cached) && (cached.pairCount() == 36));
+    CHECK(!cache.find(1, fit + 1, &cached));
+    CHECK(!cache.find(1, fit + 2, &cached));
+    CHECK(cache.find(1, fit + 3, &cached) && (cached.protocol == IR_PROTOCOL_NEC) && (cached.command == 0x08));
+    CHECK(cache.find(1, fit + 4, &cached) && (cached.protocol == IR_PROTOCOL_SIRC12));
+    CHECK(cache.find(1, fit + 5, &cached) && (cached.pairCount() == 11));
+    CHECK(cache.size() == fit * 72 + 22);
+}
+
+int main()
+{
+    unsigned short timing[2 * IR_MAX_PAIRS];
+    int on[IR_MAX_PAIRS];
+    int off[IR_MAX_PAIRS];
+    char line[LINE_SIZE];
+    IRCode code;
+    double start;
+    double elapsed;
+    double legacy_ns;
+    double pronto_ns;
+    long parsed;
+
+    loadCorpus();
+    checkParsers();
+    checkCache();
+    checkCacheFull();
+    if (corpusLines == 0) return host_failures();
+
+    //Old parser - works on a copy, like the file line buffer it was given
+    parsed = 0;
+    start = host_now_ns();
+    do
+    {
+        for (int i = 0; i < corpusLines; i++)
+        {
+            strcpy(line, corpus[i]);
+            legacyParse(line, on, off);
+        }
+        parsed += corpusLines;
+        elapsed = host_now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    legacy_ns = elapsed / parsed;
+
+    parsed = 0;
+    start = host_now_ns();
+    do
+    {
+        for (int i = 0; i < corpusLines; i++)
+        {
+            strcpy(line, corpus[i]);
+            parseProntoCode(line, timing, IR_MAX_PAIRS, &code);
+        }
+        parsed += corpusLines;
+        elapsed = host_now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    pronto_ns = elapsed / parsed;
+
+    printf("%d codes - sscanf: %.0f ns/code, parseProntoCode: %.0f ns/code, %.1fx\n",
+           corpusLines, legacy_ns, pronto_ns, legacy_ns / pronto_ns);
+
+    return host_failures();
+}
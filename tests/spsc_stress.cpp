@@ -0,0 +1,175 @@
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "host.h"
+#include "SPSCRing.h"
+
+#define STREAM_BYTES    4000000
+#define FRAME_COUNT     1000000
+#define FRAME_MAX       40
+#define QUEUE_SIZE      16                  // SERIAL_FRAME_QUEUE
+
+//**************************************************************************
+//SPSC RING STRESS
+//**************************************************************************
+// A producer thread in place of the RX interrupt & a consumer thread in
+// place of the reader: a byte stream through put() &
+// read(), then frames staged, rolled back & published through a byte
+// ring & an end queue as SerialUART does, with a consumer that now & then
+// falls behind so the rings overrun
+
+static SPSCRing<char, 256> ring;
+static SPSCRing<int, QUEUE_SIZE> ends;
+static volatile bool done;
+
+static unsigned long overruns;
+static unsigned long rollbacks;
+static unsigned long published;
+
+//**************************************************************************
+//STREAM
+//**************************************************************************
+static void* streamProducer(void*)
+{
+    for (long i = 0; i < STREAM_BYTES; i++)
+    {
+        while (!ring.put((char)i)) sched_yield();
+    }
+
+    return NULL;
+}
+
+static void streamTest()
+{
+    pthread_t producer;
+    char buffer[100];
+    long received = 0;
+    int count;
+
+    pthread_create(&producer, NULL, streamProducer, NULL);
+
+    while (received < STREAM_BYTES)
+    {
+        count = ring.read(buffer, 1 + received % sizeof(buffer));
+        if (count == 0) sched_yield();
+        for (int i = 0; i < count; i++)
+        {
+            if (buffer[i] != (char)(received + i))
+            {
+                CHECK(buffer[i] == (char)(received + i));
+                received = STREAM_BYTES;
+                break;
+            }
+        }
+        received += count;
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(ring.empty());
+}
+
+//**************************************************************************
+//FRAMES
+//**************************************************************************
+// Frame: length, 4 byte sequence, (sequence + i) pattern
+static void* frameProducer(void*)
+{
+    unsigned int seed = 1;
+    unsigned long sequence = 0;
+    int length;
+    bool full;
+
+    while (sequence < FRAME_COUNT)
+    {
+        seed = seed * 1103515245 + 12345;
+        length = 5 + (seed >> 16) % (FRAME_MAX - 4);
+
+        //Garbage that is staged, then rolled back
+        if ((seed >> 8) % 8 == 0)
+        {
+            for (int i = 0; i < length; i++) ring.stage(0x55);
+            ring.rollback();
+            rollbacks++;
+        }
+
+        full = !ring.stage(length) || !ring.stage(sequence >> 24) || !ring.stage(sequence >> 16) ||
+               !ring.stage(sequence >> 8) || !ring.stage(sequence);
+        for (int i = 5; (i < length) && !full; i++) full = !ring.stage(sequence + i);
+
+        //Ring or end queue full - the frame is lost, like on the wire
+        if (full || (ends.room() == 0))
+        {
+            ring.rollback();
+            overruns++;
+        }
+        else
+        {
+            ring.commit();
+            ends.put(ring.head());
+            published++;
+        }
+
+        sequence++;
+
+        //Interrupt returns - the reader gets the core on a single core host
+        if ((sequence & 3) == 0) sched_yield();
+    }
+
+    done = true;
+    return NULL;
+}
+
+static void frameTest()
+{
+    pthread_t producer;
+    unsigned char buffer[FRAME_MAX];
+    unsigned long sequence;
+    unsigned long last = 0;
+    unsigned long received = 0;
+    bool first = true;
+    int count;
+
+    done = false;
+    pthread_create(&producer, NULL, frameProducer, NULL);
+
+    while (!done || !ends.empty())
+    {
+        if (ends.empty())
+        {
+            sched_yield();
+            continue;
+        }
+
+        count = ring.read_to(ends.front(), (char*)buffer, sizeof(buffer));
+        ends.pop();
+        received++;
+
+        //Whole frame, in order, nothing of a rolled back one
+        sequence = (buffer[1] << 24) | (buffer[2] << 16) | (buffer[3] << 8) | buffer[4];
+        CHECK(count == buffer[0]);
+        CHECK(first || (sequence > last));
+        for (int i = 5; i < count; i++) CHECK(buffer[i] == (unsigned char)(sequence + i));
+        first = false;
+        last = sequence;
+
+        //Fall behind now & then
+        if ((received & 0x3FFF) == 0) usleep(200);
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(received == published);
+    CHECK(ring.empty() && ends.empty());
+
+    printf("%lu frames published, %lu lost on a full ring, %lu rolled back\n", published, overruns, rollbacks);
+}
+
+int main()
+{
+    double start = host_now_ns();
+
+    streamTest();
+    frameTest();
+
+    printf("%.1f s\n", (host_now_ns() - start) / 1e9);
+    return host_failures();
+}
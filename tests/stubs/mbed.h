@@ -0,0 +1,147 @@
+#ifndef MBED_H
+#define MBED_H
+
+// Host stand-in for the parts of mbed.h the tested modules use - the libc
+// headers, and a us ticker, Timeout, PwmOut, DigitalOut & UART registers
+// whose time & hardware the test drives
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define SIM_TIMEOUTS    8
+
+namespace mbed {
+
+class FunctionPointer
+{
+public:
+    FunctionPointer() { function = NULL; object = NULL; thunk = NULL; }
+
+    void attach(void (*function)(void)) { this->function = function; object = NULL; }
+    template<typename T>
+    void attach(T* object, void (T::*member)(void))
+    {
+        this->object = object;
+        memcpy(this->member, &member, sizeof(member));
+        thunk = &FunctionPointer::callMember<T>;
+    }
+
+    void call() { if (object != NULL) thunk(object, member); else if (function != NULL) function(); }
+
+private:
+    template<typename T>
+    static void callMember(void* object, char* member)
+    {
+        void (T::*m)(void);
+        memcpy(&m, member, sizeof(m));
+        (static_cast<T*>(object)->*m)();
+    }
+
+    void (*function)(void);
+    void* object;
+    char member[2 * sizeof(void*)];
+    void (*thunk)(void*, char*);
+};
+
+typedef int PinName;
+
+class Timeout;
+class PwmOut;
+
+//Simulation state - defined by the test
+struct Simulation
+{
+    uint32_t now_us;
+    Timeout* timeouts[SIM_TIMEOUTS];
+    int timeoutCount;
+    void (*pwmWrite)(PwmOut* pwm, float value);
+    void (*uartWrite)(uint32_t c);          // THR of any UART
+    uint32_t (*uartStatus)();               // LSR of any UART
+};
+extern Simulation simulation;
+
+// Fires when the test advances the time past due_us
+class Timeout
+{
+public:
+    Timeout() { armed = false; due_us = 0; if (simulation.timeoutCount < SIM_TIMEOUTS) simulation.timeouts[simulation.timeoutCount++] = this; }
+
+    void attach_us(void (*function)(void), unsigned int us) { handler.attach(function); arm(us); }
+    template<typename T>
+    void attach_us(T* object, void (T::*member)(void), unsigned int us) { handler.attach(object, member); arm(us); }
+    void detach() { armed = false; }
+
+    bool armed;
+    uint32_t due_us;
+    FunctionPointer handler;
+
+private:
+    void arm(unsigned int us) { due_us = simulation.now_us + us; armed = true; }
+};
+
+class PwmOut
+{
+public:
+    PwmOut() { period_s = 0; }
+
+    void period(float seconds) { period_s = seconds; }
+    void write(float value) { if (simulation.pwmWrite != NULL) simulation.pwmWrite(this, value); }
+
+    float period_s;
+};
+
+class DigitalOut
+{
+public:
+    DigitalOut(PinName pin = 0, int value = 0) { this->value = value; }
+
+    void write(int value) { this->value = value; }
+    int read() { return value; }
+
+    int value;
+};
+
+// Transmit side only - the test calls irq[TxIrq] when its UART model empties the FIFO
+class Serial
+{
+public:
+    enum IrqType { RxIrq = 0, TxIrq };
+
+    Serial(PinName tx, PinName rx) { rate = 9600; }
+
+    void baud(int baudrate) { rate = baudrate; }
+    int readable() { return 0; }
+    template<typename T>
+    void attach(T* object, void (T::*member)(void), IrqType type) { irq[type].attach(object, member); }
+
+    int rate;
+    FunctionPointer irq[2];
+};
+
+}
+
+//UART registers - every port goes to the one UART model of the test
+struct SimTHR { void operator=(uint32_t c) { if (mbed::simulation.uartWrite != NULL) mbed::simulation.uartWrite(c); } };
+struct SimLSR { operator uint32_t() const { return (mbed::simulation.uartStatus != NULL) ? mbed::simulation.uartStatus() : 0x60; } };
+
+struct LPC_UART_TypeDef
+{
+    uint32_t RBR;
+    SimTHR THR;
+    SimLSR LSR;
+};
+typedef LPC_UART_TypeDef LPC_UART1_TypeDef;
+
+inline LPC_UART_TypeDef* sim_uart() { static LPC_UART_TypeDef registers; return &registers; }
+#define LPC_UART0   (sim_uart())
+#define LPC_UART1   (sim_uart())
+#define LPC_UART2   (sim_uart())
+#define LPC_UART3   (sim_uart())
+
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+
+using namespace mbed;
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef RTOS_H
+#define RTOS_H
+
+// Host stand-in for the RTX calls of SerialUART - nothing ever waits
+#include <stdint.h>
+
+typedef void* osThreadId;
+#define osWaitForever 0xFFFFFFFF
+
+inline int32_t osSignalSet(osThreadId thread, int32_t signal) { return 0; }
+
+class Semaphore
+{
+public:
+    Semaphore(int32_t count) {}
+
+    int32_t wait(uint32_t ms = osWaitForever) { return 0; }
+    int release() { return 0; }
+};
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef US_TICKER_API_H
+#define US_TICKER_API_H
+
+#include "mbed.h"
+
+inline uint32_t us_ticker_read() { return simulation.now_us; }
+
+#endif
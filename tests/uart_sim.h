@@ -0,0 +1,114 @@
+#ifndef uart_sim_H
+#define uart_sim_H
+
+#include "mbed.h"
+
+#define UART_SIM_FIFO       16
+#define UART_SIM_LINE       4096
+
+//**************************************************************************
+//UART MODEL
+//**************************************************************************
+// LPC1768 UART transmitter on the simulated us ticker: a 16 byte FIFO feeding
+// the shift register, 10 bits per character at the baud rate. The THRE
+// interrupt fires when the FIFO runs empty. Time moves 1 us per step() and the
+// due Timeouts fire after the UART has moved.
+// The test defines: UARTSim uart_sim;
+
+struct UARTSim
+{
+    double char_us;                     // one character on the line
+    double clock_us;                    // simulated time, does not wrap
+    unsigned char fifo[UART_SIM_FIFO];
+    int fifoCount;
+    bool shifting;
+    double shiftEnd_us;
+    bool thre;                          // THRE interrupt pending
+    FunctionPointer* txIrq;
+
+    unsigned char line[UART_SIM_LINE];  // bytes as they enter the shift register
+    int lineCount;
+    int lost;                           // written to a full FIFO
+    double temt_us;                     // transmitter last went empty
+};
+extern UARTSim uart_sim;
+
+static inline uint32_t uart_sim_status()
+{
+    uint32_t lsr = 0;
+
+    if (uart_sim.fifoCount == 0) lsr |= 0x20;
+    if ((uart_sim.fifoCount == 0) && !uart_sim.shifting) lsr |= 0x40;
+
+    return lsr;
+}
+
+// A byte goes straight to an idle shift register - the FIFO is empty again - else into the FIFO
+static inline void uart_sim_write(uint32_t c)
+{
+    if (!uart_sim.shifting)
+    {
+        uart_sim.shifting = true;
+        uart_sim.shiftEnd_us = uart_sim.clock_us + uart_sim.char_us;
+        uart_sim.line[uart_sim.lineCount % UART_SIM_LINE] = c;
+        uart_sim.lineCount++;
+        uart_sim.thre = true;
+        return;
+    }
+
+    uart_sim.thre = false;
+
+    if (uart_sim.fifoCount == UART_SIM_FIFO) uart_sim.lost++;
+    else uart_sim.fifo[uart_sim.fifoCount++] = c;
+}
+
+static inline void uart_sim_attach(Serial& serial, int baudrate, uint32_t now_us)
+{
+    memset(&uart_sim, 0, sizeof(uart_sim));
+    uart_sim.char_us = 10 * 1e6 / baudrate;
+    uart_sim.txIrq = &serial.irq[Serial::TxIrq];
+    simulation.now_us = now_us;
+    simulation.uartWrite = uart_sim_write;
+    simulation.uartStatus = uart_sim_status;
+}
+
+static inline void uart_sim_step()
+{
+    simulation.now_us++;
+    uart_sim.clock_us += 1;
+
+    //Characters complete back to back, the next one from the FIFO
+    while (uart_sim.shifting && (uart_sim.clock_us >= uart_sim.shiftEnd_us))
+    {
+        if (uart_sim.fifoCount == 0)
+        {
+            uart_sim.shifting = false;
+            uart_sim.temt_us = uart_sim.shiftEnd_us;
+            break;
+        }
+
+        uart_sim.line[uart_sim.lineCount % UART_SIM_LINE] = uart_sim.fifo[0];
+        uart_sim.lineCount++;
+        memmove(uart_sim.fifo, uart_sim.fifo + 1, --uart_sim.fifoCount);
+        uart_sim.shiftEnd_us += uart_sim.char_us;
+        if (uart_sim.fifoCount == 0) uart_sim.thre = true;
+    }
+
+    if (uart_sim.thre)
+    {
+        uart_sim.thre = false;
+        uart_sim.txIrq->call();
+    }
+
+    for (int i = 0; i < simulation.timeoutCount; i++)
+    {
+        Timeout* t = simulation.timeouts[i];
+        if (t->armed && ((int)(simulation.now_us - t->due_us) >= 0))
+        {
+            t->armed = false;
+            t->handler.call();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+#include "host.h"
+#include "mbed.h"
+#include "us_ticker_api.h"
+#include "uart_sim.h"
+#include "SerialUART.h"
+
+#define GUARD_US        500
+#define STEP_MAX        10000000
+
+//**************************************************************************
+//RS485 TRANSMIT
+//**************************************************************************
+// Sends frames through SerialUART on a simulated UART & us ticker. The driver
+// enable must rise once the turnaround guard after the last received byte has
+// passed, stay up while a byte is on the line and drop only after TEMT, and
+// the occupancy the driver reports must be the frame time at the baud rate.
+
+mbed::Simulation mbed::simulation;
+UARTSim uart_sim;
+
+static SerialUART<1> RS485(0, 0);
+static DigitalOut RS485_Mode;
+
+struct Burst
+{
+    uint32_t rise_us;
+    uint32_t fall_us;
+    int offLine;                            // bytes on the line with the driver off
+    bool temt;                              // transmitter empty as the driver dropped
+};
+
+//Send & run until the driver drops - edges in ticker time
+static Burst run(const char* frame, int length)
+{
+    Burst burst;
+    int lineCount = uart_sim.lineCount;
+    int de;
+
+    memset(&burst, 0, sizeof(burst));
+
+    CHECK(RS485.send(frame, length));
+    de = RS485_Mode.read();
+    if (de) burst.rise_us = simulation.now_us;
+
+    for (int step = 0; step < STEP_MAX; step++)
+    {
+        uart_sim_step();
+
+        if (uart_sim.lineCount != lineCount)
+        {
+            if (!RS485_Mode.read()) burst.offLine++;
+            lineCount = uart_sim.lineCount;
+        }
+
+        if (!de && RS485_Mode.read()) burst.rise_us = simulation.now_us;
+        if (de && !RS485_Mode.read())
+        {
+            burst.fall_us = simulation.now_us;
+            burst.temt = (uart_sim_status() & UART_LSR_TEMT) != 0;
+            return burst;
+        }
+        de = RS485_Mode.read();
+    }
+
+    CHECK(false);
+    return burst;
+}
+
+//Receive a byte at rx_us, send length bytes at send_us - the driver must rise at rise_us
+static void checkFrame(int baudrate, uint32_t rx_us, uint32_t send_us, uint32_t rise_us, int length)
+{
+    char frame[256];
+    Burst burst;
+    unsigned long bursts = RS485.tx_bursts;
+    unsigned long maxBefore = RS485.tx_max_us;
+    double frame_us;
+
+    for (int i = 0; i < length; i++) frame[i] = i * 7 + baudrate;
+
+    uart_sim_attach(RS485, baudrate, rx_us);
+    RS485.baud(baudrate);
+    RS485.irq[Serial::RxIrq].call();
+    while (simulation.now_us != send_us) uart_sim_step();
+
+    burst = run(frame, length);
+    frame_us = length * uart_sim.char_us;
+
+    CHECK(burst.rise_us == rise_us);
+    CHECK(burst.temt);
+    CHECK(burst.offLine == 0);
+    CHECK(uart_sim.lost == 0);
+    CHECK(uart_sim.lineCount == length);
+    CHECK(memcmp(uart_sim.line, frame, length) == 0);
+
+    //DE covers the frame, plus at most a character of drain polling
+    CHECK(burst.fall_us - burst.rise_us >= frame_us);
+    CHECK(burst.fall_us - burst.rise_us <= frame_us + uart_sim.char_us + 2);
+
+    CHECK(RS485.tx_bursts == bursts + 1);
+    CHECK(RS485.tx_last_us == burst.fall_us - burst.rise_us);
+    CHECK(RS485.tx_max_us == ((RS485.tx_last_us > maxBefore) ? RS485.tx_last_us : maxBefore));
+    CHECK(!RS485.tx_busy());
+
+    printf("%6d baud, %3d bytes: DE %4u us after rx, occupancy %6lu us for a %8.1f us frame\n",
+           baudrate, length, (unsigned int)(burst.rise_us - rx_us), RS485.tx_last_us, frame_us);
+}
+
+int main()
+{
+    RS485.driver_enable(&RS485_Mode, GUARD_US);
+
+    //Inside the guard - the driver waits for it
+    checkFrame(9600, 1000, 1100, 1000 + GUARD_US, 200);
+
+    //Line quiet for longer - the driver rises at once, a shorter burst leaves the maximum
+    checkFrame(115200, 5000, 9000, 9000, 10);
+    checkFrame(115200, 5000, 9000, 9000, 1);
+    checkFrame(19200, 5000, 9000, 9000, 255);
+
+    //Guard across the ticker wrap
+    checkFrame(9600, 0xFFFFFF80, 0x00000010, 0xFFFFFF80 + GUARD_US, 40);
+
+    return host_failures();
+}
@@ -0,0 +1,201 @@
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "host.h"
+#include "PacketCodec.h"
+
+#define UDP_PORT        51984               // main.cpp
+#define SYSTEM_IR_STATUS    3               // 'R' is answered with one 'S' frame
+#define RELAY_1             21              // 'W' is answered with its 'S' feedback
+#define REPLY_TIMEOUT_MS    1000
+#define SAMPLE_MAX      100000
+#define BURST_WINDOW    8                   // commands in flight - the unit has few receive buffers
+
+//**************************************************************************
+//UDP LATENCY
+//**************************************************************************
+// Command turnaround of a running unit: N commands one after the other,
+// each timed until its 'S' reply, then N commands with BURST_WINDOW in flight.
+// With a value the command is a 'W' of that byte, as a panel sends, timed
+// until the 'S' feedback of the channel - the unit must have no multicast
+// group, it publishes the feedback there instead. Without one it is an 'R'
+// of a system channel, which only times the receive & reply path.
+//   udp_latency <address> [deviceID] [count] [channel [value]]
+//   udp_latency <address> 1 1000 21 1     relay 1 on
+//   udp_latency --loopback     against a responder thread on 127.0.0.1
+
+static double samples[SAMPLE_MAX];
+
+static int compareDouble(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+//Wait for the 'S' frame of channel - false on timeout
+static bool receiveReply(int sock, char channel)
+{
+    char buffer[1500];
+    PacketFrame packet;
+    int length;
+
+    while (true)
+    {
+        length = recv(sock, buffer, sizeof(buffer), 0);
+        if (length < 0) return false;
+
+        //Feedback to a learned subscriber may arrive in between
+        if (packetDecode(buffer, length, &packet) && (packet.dataType == PACKET_TYPE_STATUS) && (packet.channel == channel)) return true;
+    }
+}
+
+// value < 0 - 'R' of channel, else 'W' of value
+static int measure(const char* address, int port, char deviceID, int count, char channel, int value)
+{
+    struct sockaddr_in remote;
+    struct timeval timeout;
+    char frame[PACKET_OVERHEAD + 1];
+    char data = value;
+    int frameLength;
+    int sock;
+    int received = 0;
+    int sent = 0;
+    int lost = 0;
+    double start;
+    double elapsed;
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(port);
+    remote.sin_addr.s_addr = inet_addr(address);
+    if ((sock < 0) || (connect(sock, (struct sockaddr*)&remote, sizeof(remote)) < 0))
+    {
+        printf("%s:%d: cannot connect\n", address, port);
+        return -1;
+    }
+
+    timeout.tv_sec = REPLY_TIMEOUT_MS / 1000;
+    timeout.tv_usec = (REPLY_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (value < 0) frameLength = packetEncode(frame, deviceID, 'R', channel, NULL, 0);
+    else frameLength = packetEncode(frame, deviceID, 'W', channel, &data, 1);
+
+    //One at a time - turnaround of each command
+    for (int i = 0; i < count; i++)
+    {
+        start = host_now_ns();
+        send(sock, frame, frameLength, 0);
+
+        if (receiveReply(sock, channel)) samples[received++] = (host_now_ns() - start) / 1e3;
+        else lost++;
+    }
+
+    if (received > 0)
+    {
+        qsort(samples, received, sizeof(samples[0]), compareDouble);
+        printf("turnaround of %d '%c' commands: p50 %.0f us, p99 %.0f us, max %.0f us, %d lost\n",
+               count, (value < 0) ? 'R' : 'W', samples[received / 2], samples[received * 99 / 100], samples[received - 1], lost);
+    }
+
+    //Pipelined - every reply lets the next command go, until the socket stays quiet
+    start = host_now_ns();
+    received = 0;
+    for (sent = 0; (sent < count) && (sent < BURST_WINDOW); sent++) send(sock, frame, frameLength, 0);
+    while ((received < count) && receiveReply(sock, channel))
+    {
+        received++;
+        if (sent < count)
+        {
+            send(sock, frame, frameLength, 0);
+            sent++;
+        }
+    }
+    elapsed = host_now_ns() - start - ((received < count) ? REPLY_TIMEOUT_MS * 1e6 : 0);
+
+    printf("%d commands, %d in flight: %d replies, %.0f commands/s\n", count, BURST_WINDOW, received, received / elapsed * 1e9);
+
+    close(sock);
+    return lost;
+}
+
+//**************************************************************************
+//LOOPBACK
+//**************************************************************************
+static int responderSocket;
+
+//Answers every 'R' & 'W' with an 'S' of the same channel & data
+static void* responder(void*)
+{
+    char buffer[1500];
+    char reply[PACKET_MAX_SIZE];
+    struct sockaddr_in remote;
+    socklen_t remoteLength;
+    PacketFrame packet;
+    int length;
+
+    while (true)
+    {
+        remoteLength = sizeof(remote);
+        length = recvfrom(responderSocket, buffer, sizeof(buffer), 0, (struct sockaddr*)&remote, &remoteLength);
+        if (length <= 0) break;
+
+        if (!packetDecode(buffer, length, &packet) || ((packet.dataType != 'R') && (packet.dataType != 'W'))) continue;
+
+        length = packetEncode(reply, packet.deviceID, PACKET_TYPE_STATUS, packet.channel, packet.data, packet.dataLength);
+        sendto(responderSocket, reply, length, 0, (struct sockaddr*)&remote, remoteLength);
+    }
+
+    return NULL;
+}
+
+static void loopback()
+{
+    struct sockaddr_in local;
+    socklen_t localLength = sizeof(local);
+    pthread_t thread;
+
+    responderSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(bind(responderSocket, (struct sockaddr*)&local, sizeof(local)) == 0);
+    getsockname(responderSocket, (struct sockaddr*)&local, &localLength);
+
+    pthread_create(&thread, NULL, responder, NULL);
+    CHECK(measure("127.0.0.1", ntohs(local.sin_port), 1, 2000, SYSTEM_IR_STATUS, -1) == 0);
+    CHECK(measure("127.0.0.1", ntohs(local.sin_port), 1, 2000, RELAY_1, 1) == 0);
+
+    shutdown(responderSocket, SHUT_RDWR);
+    pthread_join(thread, NULL);
+    close(responderSocket);
+}
+
+int main(int argc, char* argv[])
+{
+    int count;
+
+    if ((argc > 1) && (strcmp(argv[1], "--loopback") == 0))
+    {
+        loopback();
+        return host_failures();
+    }
+
+    if (argc < 2)
+    {
+        printf("udp_latency <address> [deviceID] [count] [channel [value]]\n");
+        return 2;
+    }
+
+    count = (argc > 3) ? atoi(argv[3]) : 1000;
+    if (count > SAMPLE_MAX) count = SAMPLE_MAX;
+
+    return (measure(argv[1], UDP_PORT, (argc > 2) ? atoi(argv[2]) : 1, count, (argc > 4) ? atoi(argv[4]) : SYSTEM_IR_STATUS,
+                    (argc > 5) ? strtol(argv[5], NULL, 0) : -1) == 0) ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include "host.h"
+#include "mbed.h"
+#include "us_ticker_api.h"
+#include "uart_sim.h"
+#include "SerialUART.h"
+
+#define BAUDRATE        9600
+#define PAYLOAD         255
+#define BEFORE_RUNS     10
+#define AFTER_RUNS      200
+
+//**************************************************************************
+//RS232 WRITE
+//**************************************************************************
+// Thread time per 255 byte payload on a simulated UART at 9600 baud.
+// Before: one printf("%c") per byte, each formatted & then pushed out by
+// serial_putc, which spins on THRE. After: writeRS232() - send() copies the
+// payload into the TX ring & returns, the TX interrupt streams it.
+// A second payload while the first still drains is refused at once.
+
+mbed::Simulation mbed::simulation;
+UARTSim uart_sim;
+
+static SerialUART<3> RS232_1(0, 0);
+static Serial RS232_polled(0, 0);
+
+//serial_putc - wait for room in the FIFO
+static unsigned long putcPolled(char c)
+{
+    unsigned long spin_us = 0;
+
+    while ((uart_sim_status() & UART_LSR_THRE) == 0)
+    {
+        uart_sim_step();
+        spin_us++;
+    }
+    simulation.uartWrite(c);
+
+    return spin_us;
+}
+
+//Let the line go quiet
+static void drain()
+{
+    while (RS232_1.tx_busy() || !(uart_sim_status() & UART_LSR_TEMT)) uart_sim_step();
+}
+
+int main()
+{
+    char payload[PAYLOAD];
+    char formatted[4];
+    double start;
+    double format_ns = 0;
+    double send_ns = 0;
+    unsigned long spin_us = 0;
+
+    for (int i = 0; i < PAYLOAD; i++) payload[i] = i;
+
+    //Before - printf("%c") per byte
+    uart_sim_attach(RS232_polled, BAUDRATE, 0);
+    for (int run = 0; run < BEFORE_RUNS; run++)
+    {
+        for (int i = 0; i < PAYLOAD; i++)
+        {
+            start = host_now_ns();
+            snprintf(formatted, sizeof(formatted), "%c", payload[i]);
+            format_ns += host_now_ns() - start;
+
+            spin_us += putcPolled(formatted[0]);
+        }
+        while (!(uart_sim_status() & UART_LSR_TEMT)) uart_sim_step();
+    }
+    CHECK(uart_sim.lineCount == BEFORE_RUNS * PAYLOAD);
+
+    printf("before: printf(\"%%c\") x %d  %8.0f ns formatting + %6lu us spinning on THRE per payload\n",
+           PAYLOAD, format_ns / BEFORE_RUNS, spin_us / BEFORE_RUNS);
+
+    //After - one copy into the TX ring
+    uart_sim_attach(RS232_1, BAUDRATE, 0);
+    RS232_1.baud(BAUDRATE);
+    for (int run = 0; run < AFTER_RUNS; run++)
+    {
+        start = host_now_ns();
+        CHECK(RS232_1.send(payload, PAYLOAD));
+        send_ns += host_now_ns() - start;
+
+        drain();
+        if (run == 0) CHECK(memcmp(uart_sim.line, payload, PAYLOAD) == 0);
+    }
+    CHECK(uart_sim.lost == 0);
+    CHECK(uart_sim.lineCount == AFTER_RUNS * PAYLOAD);
+
+    printf("after:  send()                  %8.0f ns queueing,             0 us waiting per payload\n", send_ns / AFTER_RUNS);
+
+    //Back to back - the second payload does not fit until the first has drained
+    CHECK(RS232_1.send(payload, PAYLOAD));
+    uart_sim_step();
+    CHECK(!RS232_1.send(payload, PAYLOAD));
+    CHECK(RS232_1.tx_drops == 1);
+    CHECK(RS232_1.write_nonblocking(payload, PAYLOAD) < PAYLOAD);
+    drain();
+
+    return host_failures();
+}